@@ -0,0 +1,252 @@
+/**
+ * File: Badspot.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  An implementation of Badspot.hpp
+ */
+
+#include "Badspot.hpp"
+#include "HotspotDefaults.hpp"
+
+#include <algorithm>
+#include <climits>
+
+namespace hotspot
+{
+	static const unsigned int TAG_BUFFER_SIZE = 1 << 16; // bytes of tag lines written at a time
+
+	static void AppendInt( std::string& out, unsigned int value )
+	{
+		char digits[16];
+		int n = 0;
+		do
+		{
+			digits[ n++ ] = '0' + value % 10;
+			value /= 10;
+		} while( value > 0 );
+		while( n > 0 )
+		{
+			out += digits[ --n ];
+		}
+	}
+
+	BadspotScanner::BadspotScanner( const BadspotParams& params, std::FILE* badspots, std::FILE* tags )
+		: _params( params ), _badspots( badspots ), _tags( tags ), _hasExtent( false ),
+		  _chromStart( 0 ), _chromEnd( 0 ), _omit( NULL ), _lastTag( -1 )
+	{
+		_scans[0].offset = 0;
+		_scans[1].offset = params.step / 2;
+		_buffer.reserve( TAG_BUFFER_SIZE + HotspotDefaults::MAX_CHROM_NAME_LEN + 32 );
+	}
+
+	void BadspotScanner::startChrom( const std::string& chromName, const Interval* extent, const IntervalSet* omit )
+	{
+		_chromName = chromName;
+		_hasExtent = ( extent != NULL );
+		_chromStart = _hasExtent ? extent->start : 0;
+		_chromEnd = _hasExtent ? extent->end : 0;
+		_omit = omit;
+		_lastTag = -1;
+		for( int s = 0; s < 2; s++ )
+		{
+			Scan& scan = _scans[s];
+			long long first = static_cast< long long >( _chromStart ) + scan.offset;
+			scan.next = 0;
+			scan.numWindows = ( ! _hasExtent || first > _chromEnd ) ? 0 : ( _chromEnd - first ) / _params.step + 1;
+			scan.found.clear( );
+			scan.covering = 0;
+		}
+		_window.clear( );
+		_pending.clear( );
+	}
+
+	int BadspotScanner::left( long long center, int pad ) const
+	{
+		return static_cast< int >( std::max( 0LL, center - pad ) );
+	}
+
+	int BadspotScanner::right( long long center, int pad ) const
+	{
+		return static_cast< int >( std::min( static_cast< long long >( _chromEnd ), center + pad ) );
+	}
+
+	long long BadspotScanner::firstReaching( const Scan& scan, long long pos, int pad ) const
+	{
+		long long d = pos - pad - _chromStart - scan.offset;
+		return ( d < 0 ) ? 0 : d / _params.step + 1;
+	}
+
+	void BadspotScanner::score( Scan& scan, long long horizon )
+	{
+		int smallPad = _params.smallWin / 2;
+		int largePad = _params.largeWin / 2;
+		while( scan.next < scan.numWindows )
+		{
+			long long c = center( scan, scan.next );
+			int largeRight = right( c, largePad );
+			if( largeRight > horizon )
+			{
+				break; // tags still to come may fall in it
+			}
+
+			int smallLeft = left( c, smallPad );
+			int smallRight = right( c, smallPad );
+			std::deque< int >::iterator first = std::lower_bound( _window.begin( ), _window.end( ), smallLeft );
+			if( first == _window.end( ) )
+			{
+				// Nothing in this window, or any up to the horizon
+				scan.next = ( horizon >= _chromEnd )
+					? scan.numWindows
+					: std::max( scan.next + 1, firstReaching( scan, horizon, largePad ) );
+				break;
+			}
+			if( *first >= smallRight )
+			{
+				// Skip to the first window that holds the next tag
+				scan.next = std::max( scan.next + 1, firstReaching( scan, *first, smallPad ) );
+				continue;
+			}
+
+			int numSmall = std::lower_bound( first, _window.end( ), smallRight ) - first;
+			if( numSmall >= _params.minTags )
+			{
+				int numLarge = std::lower_bound( _window.begin( ), _window.end( ), largeRight )
+							 - std::lower_bound( _window.begin( ), _window.end( ), left( c, largePad ) );
+				if( static_cast< double >( numSmall ) / numLarge >= _params.thresh )
+				{
+					scan.found.push_back( Interval( smallLeft, smallRight ) );
+				}
+			}
+			scan.next++;
+		}
+	}
+
+	bool BadspotScanner::addTag( int pos )
+	{
+		if( pos < _lastTag )
+		{
+			return false;
+		}
+		if( _hasExtent && pos > _lastTag )
+		{
+			score( _scans[0], pos );
+			score( _scans[1], pos );
+		}
+		_lastTag = pos;
+		if( _hasExtent && pos < _chromEnd )
+		{
+			_window.push_back( pos );
+		}
+		if( _tags != NULL )
+		{
+			_pending.push_back( pos );
+		}
+		release( );
+		return true;
+	}
+
+	void BadspotScanner::release( )
+	{
+		int smallPad = _params.smallWin / 2;
+		int largePad = _params.largeWin / 2;
+		int keepFrom = INT_MAX;
+		int finalBelow = INT_MAX;
+		for( int s = 0; s < 2; s++ )
+		{
+			const Scan& scan = _scans[s];
+			if( scan.next < scan.numWindows )
+			{
+				long long c = center( scan, scan.next );
+				keepFrom = std::min( keepFrom, left( c, largePad ) );
+				finalBelow = std::min( finalBelow, left( c, smallPad ) );
+			}
+		}
+		while( ! _window.empty( ) && _window.front( ) < keepFrom )
+		{
+			_window.pop_front( );
+		}
+		while( ! _pending.empty( ) && _pending.front( ) < finalBelow )
+		{
+			int pos = _pending.front( );
+			_pending.pop_front( );
+			if( ! filtered( pos ) )
+			{
+				writeTag( pos );
+			}
+		}
+	}
+
+	bool BadspotScanner::filtered( int pos )
+	{
+		for( int s = 0; s < 2; s++ )
+		{
+			Scan& scan = _scans[s];
+			while( scan.covering < scan.found.size( ) && scan.found[ scan.covering ].end <= pos )
+			{
+				scan.covering++;
+			}
+			if( scan.covering < scan.found.size( ) && scan.found[ scan.covering ].start <= pos )
+			{
+				return true;
+			}
+		}
+		return _omit != NULL && _omit->coverage( pos, pos + 1 ) > 0;
+	}
+
+	void BadspotScanner::writeTag( int pos )
+	{
+		_buffer += _chromName;
+		_buffer += '\t';
+		AppendInt( _buffer, pos );
+		_buffer += '\t';
+		AppendInt( _buffer, pos + 1 );
+		_buffer += '\n';
+		if( _buffer.size( ) >= TAG_BUFFER_SIZE )
+		{
+			flush( );
+		}
+	}
+
+	void BadspotScanner::finishChrom( )
+	{
+		if( _hasExtent )
+		{
+			score( _scans[0], LLONG_MAX );
+			score( _scans[1], LLONG_MAX );
+		}
+		release( );
+
+		IntervalSet badspots;
+		for( int s = 0; s < 2; s++ )
+		{
+			const std::vector< Interval >& found = _scans[s].found;
+			for( unsigned int i = 0; i < found.size( ); i++ )
+			{
+				badspots.add( found[i].start, found[i].end );
+			}
+		}
+		badspots.merge( );
+		const std::vector< Interval >& merged = badspots.intervals( );
+		for( unsigned int i = 0; i < merged.size( ); i++ )
+		{
+			std::fprintf( _badspots, "%s\t%d\t%d\n", _chromName.c_str( ), merged[i].start, merged[i].end );
+		}
+	}
+
+	bool BadspotScanner::flush( )
+	{
+		if( _tags == NULL )
+		{
+			return ! std::ferror( _badspots );
+		}
+		if( ! _buffer.empty( ) )
+		{
+			std::fwrite( _buffer.data( ), 1, _buffer.size( ), _tags );
+			_buffer.clear( );
+		}
+		return ! std::ferror( _tags ) && ! std::ferror( _badspots );
+	}
+}
@@ -0,0 +1,125 @@
+/**
+ * File: Badspot.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  Badspots: tag pile-ups that are artifacts of sequencing, in place of
+ *  the tiling, bedmap and paste steps of run_badspot.  Small windows are
+ *  centered every <step> bases from each chromosome start, at offsets 0
+ *  and <step>/2, and a small window is a badspot if it holds at least
+ *  <minTags> tags and at least <thresh> of the tags of the large window
+ *  with the same center.  Windows are clipped to the chromosome, and a
+ *  tag at p lies in [left, right) if left <= p < right, as bedmap
+ *  --bp-ovr 1 counts it.
+ *
+ *  Tags arrive sorted, a chromosome at a time, and are read once: only
+ *  those that a window still to be scored can hold are kept, in a ring
+ *  buffer, and windows holding no tags are skipped over.  Each tag can be
+ *  written back out, unless it falls in a badspot or an omitted region,
+ *  as soon as no window still to be scored can cover it, so the filtered
+ *  tags come out of the same pass.
+ */
+
+#ifndef BADSPOT_HPP_
+#define BADSPOT_HPP_
+
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "IntervalSet.hpp"
+
+namespace hotspot
+{
+
+	struct BadspotParams
+	{
+		int minTags;   // fewest tags in a badspot
+		double thresh; // least share of the large window's tags in a badspot
+		int step;      // between window centers
+		int smallWin;
+		int largeWin;
+	};
+
+	class BadspotScanner
+	{
+	public:
+		/**
+		 * Write the merged badspots of each chromosome to <badspots>, and if
+		 * <tags> is not NULL, the tags outside them to <tags>
+		 */
+		BadspotScanner( const BadspotParams& params, std::FILE* badspots, std::FILE* tags );
+
+		/**
+		 * Begin chromosome <chromName>, whose windows tile <extent>; with no
+		 * extent it has no windows, and its tags are only filtered by <omit>,
+		 * which may also be NULL
+		 */
+		void startChrom( const std::string& chromName, const Interval* extent, const IntervalSet* omit );
+
+		/**
+		 * Add the next tag of the chromosome.  Returns false if it comes
+		 * before the previous one.
+		 */
+		bool addTag( int pos );
+
+		/**
+		 * Score the windows left, and write the chromosome's badspots and
+		 * remaining tags
+		 */
+		void finishChrom( );
+
+		/**
+		 * Write any buffered tags.  Returns false if a write failed.
+		 */
+		bool flush( );
+
+	private:
+		// Windows centered at one offset
+		struct Scan
+		{
+			int offset;
+			long long next;                // first window not yet scored
+			long long numWindows;
+			std::vector< Interval > found; // small windows that are badspots, in order
+			unsigned int covering;         // first of found that may cover a pending tag
+		};
+
+		long long center( const Scan& scan, long long k ) const { return _chromStart + scan.offset + _params.step * k; }
+		int left( long long center, int pad ) const;
+		int right( long long center, int pad ) const;
+
+		// First window whose center, plus <pad>, is beyond <pos>
+		long long firstReaching( const Scan& scan, long long pos, int pad ) const;
+
+		// Score every window whose large window ends by <horizon>, below which
+		// all tags have been added
+		void score( Scan& scan, long long horizon );
+
+		// Drop tags that no window left to score can hold, and write those
+		// pending tags that no window left to score can cover
+		void release( );
+		bool filtered( int pos );
+		void writeTag( int pos );
+
+		BadspotParams _params;
+		std::FILE* _badspots;
+		std::FILE* _tags;
+		std::string _chromName;
+		bool _hasExtent;
+		int _chromStart;
+		int _chromEnd;
+		const IntervalSet* _omit;
+		int _lastTag;
+		Scan _scans[2];
+		std::deque< int > _window;  // tags that windows left to score may hold
+		std::deque< int > _pending; // tags not yet written or dropped
+		std::string _buffer;
+	};
+
+} // namespace hotspot
+
+#endif /* BADSPOT_HPP_ */
@@ -0,0 +1,255 @@
+/**
+ * File: BadspotFinder.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  Entry point of hotspot-badspot, which finds the badspots of a sorted
+ *  tag stream (see Badspot.hpp) and writes the tags outside them and
+ *  any omitted regions, in place of the four tag conversions, bedmap,
+ *  paste and bedops steps of run_badspot.  The tags are read once, from
+ *  a file or standard input, as lines of <chrom> <position> with any
+ *  further columns ignored, so the BED output of sort-bed can be piped
+ *  straight in.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Badspot.hpp"
+#include "ByLine.hpp"
+#include "HotspotDefaults.hpp"
+#include "InputDataReader.hpp"
+#include "IntervalSet.hpp"
+
+namespace hotspot
+{
+	/**
+	 * Keeps the regions of each chromosome of a BED file
+	 */
+	class RegionCollector : public BedChromVisitor
+	{
+	public:
+		RegionCollector( std::map< std::string, IntervalSet >& regions ) : _regions( regions ) { }
+
+		void visit( const std::string& chromName, IntervalSet& regions )
+		{
+			_regions[ chromName ] = regions;
+		}
+
+	private:
+		std::map< std::string, IntervalSet >& _regions;
+	};
+
+	/**
+	 * Read the extent of each chromosome from the BED file <fileName>, one
+	 * line per chromosome.  Returns false, after reporting why, on error.
+	 */
+	bool ReadChromExtents( const std::string& fileName, std::map< std::string, Interval >& extents )
+	{
+		std::ifstream in( fileName.c_str( ) );
+		if( ! in )
+		{
+			std::fprintf( stderr, "Error: unable to access %s\n", fileName.c_str( ) );
+			return false;
+		}
+
+		char chromName[ HotspotDefaults::MAX_CHROM_NAME_LEN + 1 ];
+		int start, end;
+		int lineNum = 0;
+		ByLine line;
+		while( in >> line )
+		{
+			lineNum++;
+			if( line.empty( ) )
+			{
+				continue;
+			}
+			if( std::sscanf( line.c_str( ), "%127s %d %d", chromName, &start, &end ) != 3 )
+			{
+				std::fprintf( stderr, "Error: input file %s contains a malformed entry on line %d\n",
+						fileName.c_str( ), lineNum );
+				return false;
+			}
+			if( ! extents.insert( std::make_pair( std::string( chromName ), Interval( start, end ) ) ).second )
+			{
+				std::fprintf( stderr, "Error: %s lists %s more than once\n", fileName.c_str( ), chromName );
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+int main( int argc, char **argv )
+{
+	std::string inputPath = "-", chromsPath, badPath, outputPath, omitPath;
+	hotspot::BadspotParams params;
+	params.minTags = hotspot::HotspotDefaults::BADSPOT_MIN_TAGS;
+	params.thresh = hotspot::HotspotDefaults::BADSPOT_THRESH;
+	params.step = hotspot::HotspotDefaults::BADSPOT_STEP;
+	params.smallWin = hotspot::HotspotDefaults::BADSPOT_WIN_SMALL;
+	params.largeWin = hotspot::HotspotDefaults::BADSPOT_WIN_LARGE;
+	for( int i = 1; i < argc; i++ )
+	{
+		bool hasValue = ( i + 1 < argc );
+		if( std::strcmp( argv[ i ], "-i" ) == 0 && hasValue )
+		{
+			inputPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-chroms" ) == 0 && hasValue )
+		{
+			chromsPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-bad" ) == 0 && hasValue )
+		{
+			badPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-o" ) == 0 && hasValue )
+		{
+			outputPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-omit" ) == 0 && hasValue )
+		{
+			omitPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-mintags" ) == 0 && hasValue )
+		{
+			params.minTags = std::atoi( argv[ ++i ] );
+		}
+		else if( std::strcmp( argv[ i ], "-thresh" ) == 0 && hasValue )
+		{
+			params.thresh = std::atof( argv[ ++i ] );
+		}
+		else
+		{
+			std::cerr << "Unrecognized option: " << argv[ i ] << ". Aborting." << std::endl;
+			std::exit( EXIT_FAILURE );
+		}
+	}
+	if( chromsPath.empty( ) || badPath.empty( ) )
+	{
+		std::string msg  = "Usage: hotspot-badspot -chroms <file-name> -bad <file-name> [options]";
+		msg += "\n    -chroms <file-name> (extent of each chromosome, bed)";
+		msg += "\n    -bad <file-name> (output badspots, bed)";
+		msg += "\n    -i <file-name> (sorted tags, bed or tag library; - for standard input - default=-)";
+		msg += "\n    -o <file-name> (also write the tags outside badspots and omitted regions; - for standard output)";
+		msg += "\n    -omit <file-name> (regions whose tags are also left out of -o, sorted bed)";
+		msg += "\n    -mintags <int> (fewest tags in a badspot - default=5)";
+		msg += "\n    -thresh <float> (least share of the 250bp window's tags in a 50bp badspot - default=0.8)";
+		msg += "\n";
+		std::cerr << msg << std::endl;
+		std::exit( EXIT_FAILURE );
+	}
+
+	std::map< std::string, hotspot::Interval > extents;
+	std::map< std::string, hotspot::IntervalSet > omit;
+	if( ! hotspot::ReadChromExtents( chromsPath, extents ) )
+	{
+		std::exit( EXIT_FAILURE );
+	}
+	if( ! omitPath.empty( ) )
+	{
+		hotspot::RegionCollector collector( omit );
+		if( ! hotspot::ReadBedChroms( omitPath, collector ) )
+		{
+			std::exit( EXIT_FAILURE );
+		}
+	}
+
+	hotspot::InputDataReader reader( inputPath );
+	std::FILE* bad = std::fopen( badPath.c_str( ), "w" );
+	if( bad == NULL )
+	{
+		std::fprintf( stderr, "Error: unable to open %s\n", badPath.c_str( ) );
+		std::exit( EXIT_FAILURE );
+	}
+	std::FILE* out = NULL;
+	if( outputPath == "-" )
+	{
+		out = stdout;
+	}
+	else if( ! outputPath.empty( ) )
+	{
+		out = std::fopen( outputPath.c_str( ), "w" );
+		if( out == NULL )
+		{
+			std::fprintf( stderr, "Error: unable to open %s\n", outputPath.c_str( ) );
+			std::exit( EXIT_FAILURE );
+		}
+	}
+
+	const char* inputName = ( inputPath == "-" ) ? "standard input" : inputPath.c_str( );
+	hotspot::BadspotScanner scanner( params, bad, out );
+	std::set< std::string > seen;
+	std::vector< int > tags;
+	while( true )
+	{
+		tags.clear( );
+		bool chromEnded = false;
+		int numRead = reader.readChromTags( tags, hotspot::HotspotDefaults::STREAM_CHUNK_TAGS, chromEnded );
+		if( numRead < 0 )
+		{
+			std::exit( EXIT_FAILURE ); // malformed input, already reported
+		}
+		if( numRead == 0 )
+		{
+			break; // every chromosome starts with a tag
+		}
+
+		const std::string chromName = reader.currentChromName( );
+		if( ! seen.insert( chromName ).second )
+		{
+			std::fprintf( stderr, "Error: %s must be sorted; %s appears in more than one place\n",
+					inputName, chromName.c_str( ) );
+			std::exit( EXIT_FAILURE );
+		}
+		std::map< std::string, hotspot::Interval >::const_iterator extent = extents.find( chromName );
+		std::map< std::string, hotspot::IntervalSet >::const_iterator omitted = omit.find( chromName );
+		scanner.startChrom( chromName, extent == extents.end( ) ? NULL : &extent->second,
+							omitted == omit.end( ) ? NULL : &omitted->second );
+		while( true )
+		{
+			for( unsigned int i = 0; i < tags.size( ); i++ )
+			{
+				if( ! scanner.addTag( tags[i] ) )
+				{
+					std::fprintf( stderr, "Error: %s must be sorted; %s is out of order at %d\n",
+							inputName, chromName.c_str( ), tags[i] );
+					std::exit( EXIT_FAILURE );
+				}
+			}
+			if( chromEnded )
+			{
+				break;
+			}
+			tags.clear( );
+			if( reader.readChromTags( tags, hotspot::HotspotDefaults::STREAM_CHUNK_TAGS, chromEnded ) < 0 )
+			{
+				std::exit( EXIT_FAILURE );
+			}
+		}
+		scanner.finishChrom( );
+	}
+
+	bool ok = scanner.flush( );
+	ok = ( std::fclose( bad ) == 0 ) && ok;
+	if( out != NULL )
+	{
+		ok = ( std::fclose( out ) == 0 ) && ok;
+	}
+	if( ! ok )
+	{
+		std::fprintf( stderr, "Error: unable to write %s\n", outputPath.empty( ) ? badPath.c_str( ) : outputPath.c_str( ) );
+		std::exit( EXIT_FAILURE );
+	}
+	std::exit( EXIT_SUCCESS );
+}
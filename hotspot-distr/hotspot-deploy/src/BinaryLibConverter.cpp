@@ -0,0 +1,70 @@
+/**
+ * File: BinaryLibConverter.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  Entry point of hotspot-binlib, which converts a text tag library
+ *  (lines of <chrom> <position>) to the binary format of
+ *  BinaryTagLibrary.hpp.  hotspot reads either form of library.
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BinaryTagLibrary.hpp"
+#include "InputDataReader.hpp"
+
+int main( int argc, char **argv )
+{
+	if( argc != 3 )
+	{
+		std::cerr << "Usage: hotspot-binlib <text tag library> <binary tag library>" << std::endl;
+		std::exit( EXIT_FAILURE );
+	}
+	std::string inputFileName = argv[1];
+	std::string outputFileName = argv[2];
+
+	hotspot::InputDataReader inputDataReader( inputFileName );
+	std::FILE* fp = std::fopen( outputFileName.c_str( ), "wb" );
+	if( fp == NULL )
+	{
+		std::fprintf( stderr, "Error: unable to open %s: %s\n", outputFileName.c_str( ), std::strerror( errno ) );
+		std::exit( EXIT_FAILURE );
+	}
+
+	hotspot::BinaryTagLibraryWriter writer( fp );
+	std::vector< int > tags;
+	long long totalTags = 0;
+	int numTags;
+	bool ok = true;
+	while( ok && ( numTags = inputDataReader.readNextChrom( tags ) ) > 0 )
+	{
+		ok = writer.addChrom( inputDataReader.currentChromName( ), tags );
+		totalTags += tags.size( );
+		tags.clear( );
+	}
+	if( numTags < 0 )
+	{
+		ok = false; // malformed input, already reported
+	}
+	else if( ! ok || ! writer.finish( ) || std::fclose( fp ) != 0 )
+	{
+		std::fprintf( stderr, "Error: unable to write %s\n", outputFileName.c_str( ) );
+		ok = false;
+	}
+	if( ! ok )
+	{
+		std::remove( outputFileName.c_str( ) );
+		std::exit( EXIT_FAILURE );
+	}
+
+	std::cout << "TotalTagCount: " << totalTags << std::endl;
+	std::exit( EXIT_SUCCESS );
+}
@@ -0,0 +1,207 @@
+/**
+ * File: BinaryTagLibrary.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  An implementation of BinaryTagLibrary.hpp
+ */
+
+#include "BinaryTagLibrary.hpp"
+
+#include <cstring>
+
+namespace hotspot
+{
+	const char BinaryTagLibrary::MAGIC[ MAGIC_SIZE + 1 ] = "HSTAGLB1";
+
+	static uint32_t getU32( const char* p )
+	{
+		const unsigned char* u = reinterpret_cast< const unsigned char* >( p );
+		return uint32_t( u[0] ) | ( uint32_t( u[1] ) << 8 ) | ( uint32_t( u[2] ) << 16 ) | ( uint32_t( u[3] ) << 24 );
+	}
+
+	static uint64_t getU64( const char* p )
+	{
+		return uint64_t( getU32( p ) ) | ( uint64_t( getU32( p + 4 ) ) << 32 );
+	}
+
+	static void putU32( unsigned char* p, uint32_t v )
+	{
+		for( int i = 0; i < 4; i++ )
+		{
+			p[i] = ( v >> ( 8 * i ) ) & 0xff;
+		}
+	}
+
+	static void putU64( unsigned char* p, uint64_t v )
+	{
+		putU32( p, uint32_t( v ) );
+		putU32( p + 4, uint32_t( v >> 32 ) );
+	}
+
+	bool BinaryTagLibrary::isBinary( const char* data, std::size_t size )
+	{
+		return size >= MAGIC_SIZE && std::memcmp( data, MAGIC, MAGIC_SIZE ) == 0;
+	}
+
+	bool BinaryTagLibrary::readIndex( const char* data, std::size_t size,
+									  uint64_t& totalTags, std::vector< Chrom >& chroms )
+	{
+		if( size < HEADER_SIZE || ! isBinary( data, size ) )
+		{
+			return false;
+		}
+		totalTags = getU64( data + 8 );
+		uint32_t numChroms = getU32( data + 16 );
+		uint64_t tableOffset = getU64( data + 24 );
+		if( tableOffset < HEADER_SIZE || tableOffset > size )
+		{
+			return false;
+		}
+
+		chroms.clear( );
+		uint64_t sumTags = 0;
+		const char* p = data + tableOffset;
+		const char* end = data + size;
+		for( uint32_t i = 0; i < numChroms; i++ )
+		{
+			if( end - p < 24 )
+			{
+				return false;
+			}
+			Chrom chrom;
+			uint32_t numTags = getU32( p );
+			chrom.offset = getU64( p + 4 );
+			chrom.length = getU64( p + 12 );
+			uint32_t nameLength = getU32( p + 20 );
+			p += 24;
+			if( numTags > 0x7fffffff || uint64_t( end - p ) < nameLength
+				|| chrom.offset < HEADER_SIZE || chrom.offset > tableOffset
+				|| chrom.length > tableOffset - chrom.offset )
+			{
+				return false;
+			}
+			chrom.numTags = numTags;
+			chrom.name.assign( p, nameLength );
+			p += nameLength;
+			sumTags += numTags;
+			chroms.push_back( chrom );
+		}
+		return sumTags == totalTags;
+	}
+
+	bool BinaryTagLibrary::decodeTags( const char* data, const Chrom& chrom, std::vector< int >& tags )
+	{
+		const unsigned char* p = reinterpret_cast< const unsigned char* >( data + chrom.offset );
+		const unsigned char* end = p + chrom.length;
+		std::size_t first = tags.size( );
+		tags.resize( first + chrom.numTags );
+		int* out = chrom.numTags > 0 ? &tags[ first ] : NULL;
+
+		uint32_t pos = 0;
+		for( int i = 0; i < chrom.numTags; i++ )
+		{
+			uint32_t zigzag = 0;
+			int shift = 0;
+			while( true )
+			{
+				if( p == end || shift > 28 )
+				{
+					tags.resize( first );
+					return false;
+				}
+				unsigned char byte = *p++;
+				if( shift == 28 && byte > 0x0f )
+				{
+					// A fifth byte holds only the top four bits
+					tags.resize( first );
+					return false;
+				}
+				zigzag |= uint32_t( byte & 0x7f ) << shift;
+				if( byte < 0x80 )
+				{
+					break;
+				}
+				shift += 7;
+			}
+			pos += ( zigzag >> 1 ) ^ ( 0u - ( zigzag & 1 ) );
+			out[i] = static_cast< int >( pos );
+		}
+		if( p != end )
+		{
+			tags.resize( first );
+			return false;
+		}
+		return true;
+	}
+
+	BinaryTagLibraryWriter::BinaryTagLibraryWriter( std::FILE* fp )
+		: _fp( fp ), _offset( BinaryTagLibrary::HEADER_SIZE ), _totalTags( 0 )
+	{
+		// The real header is written by finish( )
+		unsigned char header[ BinaryTagLibrary::HEADER_SIZE ];
+		std::memset( header, 0, sizeof( header ) );
+		std::fwrite( header, 1, sizeof( header ), _fp );
+	}
+
+	bool BinaryTagLibraryWriter::addChrom( const std::string& name, const std::vector< int >& tags )
+	{
+		_buffer.resize( tags.size( ) * 5 );
+		unsigned char* out = _buffer.empty( ) ? NULL : &_buffer[0];
+		unsigned char* p = out;
+		uint32_t prev = 0;
+		for( unsigned int i = 0; i < tags.size( ); i++ )
+		{
+			uint32_t pos = static_cast< uint32_t >( tags[i] );
+			uint32_t delta = pos - prev;
+			uint32_t zigzag = ( delta << 1 ) ^ ( 0u - ( delta >> 31 ) );
+			while( zigzag >= 0x80 )
+			{
+				*p++ = ( zigzag & 0x7f ) | 0x80;
+				zigzag >>= 7;
+			}
+			*p++ = zigzag;
+			prev = pos;
+		}
+
+		BinaryTagLibrary::Chrom chrom;
+		chrom.name = name;
+		chrom.numTags = tags.size( );
+		chrom.offset = _offset;
+		chrom.length = p - out;
+		_chroms.push_back( chrom );
+		_offset += chrom.length;
+		_totalTags += tags.size( );
+		return std::fwrite( out, 1, chrom.length, _fp ) == chrom.length;
+	}
+
+	bool BinaryTagLibraryWriter::finish( )
+	{
+		for( unsigned int i = 0; i < _chroms.size( ); i++ )
+		{
+			const BinaryTagLibrary::Chrom& chrom = _chroms[i];
+			unsigned char entry[ 24 ];
+			putU32( entry, chrom.numTags );
+			putU64( entry + 4, chrom.offset );
+			putU64( entry + 12, chrom.length );
+			putU32( entry + 20, chrom.name.size( ) );
+			if( std::fwrite( entry, 1, sizeof( entry ), _fp ) != sizeof( entry )
+				|| std::fwrite( chrom.name.data( ), 1, chrom.name.size( ), _fp ) != chrom.name.size( ) )
+			{
+				return false;
+			}
+		}
+
+		unsigned char header[ BinaryTagLibrary::HEADER_SIZE ];
+		std::memcpy( header, BinaryTagLibrary::MAGIC, BinaryTagLibrary::MAGIC_SIZE );
+		putU64( header + 8, _totalTags );
+		putU32( header + 16, _chroms.size( ) );
+		putU32( header + 20, 0 );
+		putU64( header + 24, _offset );
+		return std::fseek( _fp, 0, SEEK_SET ) == 0
+			&& std::fwrite( header, 1, sizeof( header ), _fp ) == sizeof( header )
+			&& std::fflush( _fp ) == 0;
+	}
+}
@@ -0,0 +1,110 @@
+/**
+ * File: BinaryTagLibrary.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  A compact binary form of the text tag library.  All integers are
+ *  little-endian.  The file is laid out as
+ *
+ *    header:  magic "HSTAGLB1", uint64 total tags, uint32 chromosome
+ *             count, uint32 reserved (0), uint64 offset of the
+ *             chromosome table
+ *    data:    for each chromosome, its tag positions as varint-coded,
+ *             zigzagged differences from the previous position (the
+ *             first from 0)
+ *    table:   for each chromosome, in input order: uint32 tag count,
+ *             uint64 data offset, uint64 data length, uint32 name
+ *             length, name bytes
+ *
+ *  The table follows the data so a library can be written in one pass.
+ *  Chromosomes appear in the table exactly as the runs of the text
+ *  input, so reading a binary library gives the same results as the
+ *  text it was made from.  Sorted positions take about one byte a tag.
+ */
+
+#ifndef BINARYTAGLIBRARY_HPP_
+#define BINARYTAGLIBRARY_HPP_
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace hotspot
+{
+
+	class BinaryTagLibrary
+	{
+	public:
+		static const std::size_t MAGIC_SIZE = 8;
+		static const char MAGIC[ MAGIC_SIZE + 1 ];
+		static const std::size_t HEADER_SIZE = 32;
+
+		/**
+		 * One entry of the chromosome table
+		 */
+		struct Chrom
+		{
+			std::string name;
+			int numTags;
+			uint64_t offset;
+			uint64_t length;
+		};
+
+		/**
+		 * True if <data> starts with the binary library magic
+		 */
+		static bool isBinary( const char* data, std::size_t size );
+
+		/**
+		 * Read the header and chromosome table of the library held in
+		 * <data>.  Returns false if they are truncated or inconsistent.
+		 */
+		static bool readIndex( const char* data, std::size_t size,
+							   uint64_t& totalTags, std::vector< Chrom >& chroms );
+
+		/**
+		 * Decode the positions of <chrom>, appending them to <tags>.
+		 * Returns false if the data is corrupt.
+		 */
+		static bool decodeTags( const char* data, const Chrom& chrom, std::vector< int >& tags );
+	};
+
+	/**
+	 * Writes a binary tag library a chromosome at a time
+	 */
+	class BinaryTagLibraryWriter
+	{
+	public:
+		/**
+		 * Start a library in <fp>, which must be a new, seekable file
+		 */
+		BinaryTagLibraryWriter( std::FILE* fp );
+
+		/**
+		 * Append a chromosome.  Returns false on a write error.
+		 */
+		bool addChrom( const std::string& name, const std::vector< int >& tags );
+
+		/**
+		 * Write the chromosome table and header.  Returns false on a write error.
+		 */
+		bool finish( );
+
+	private:
+		BinaryTagLibraryWriter( const BinaryTagLibraryWriter& );
+		BinaryTagLibraryWriter& operator=( const BinaryTagLibraryWriter& );
+
+		std::FILE* _fp;
+		uint64_t _offset;
+		uint64_t _totalTags;
+		std::vector< BinaryTagLibrary::Chrom > _chroms;
+		std::vector< unsigned char > _buffer;
+	};
+
+} // namespace hotspot
+
+#endif /* BINARYTAGLIBRARY_HPP_ */
@@ -0,0 +1,146 @@
+/**
+ * File: Binomial.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  An implementation of Binomial.hpp
+ */
+
+#include "Binomial.hpp"
+
+#include <cfloat>
+#include <cmath>
+
+extern "C"
+{
+	#include <gsl/gsl_sf_gamma.h>
+	#include <gsl/gsl_errno.h>
+}
+
+namespace hotspot
+{
+	double BinomialUpperTail( int k, double n, double p )
+	{
+		if( k <= 0 )
+		{
+			return 1.0;
+		}
+		gsl_sf_result result;
+		int status = gsl_sf_beta_inc_e( k, n - k + 1, p, &result );
+		if( status == GSL_EUNDRFLW )
+		{
+			return 0.0;
+		}
+		else if( status )
+		{
+			return 1.0;
+		}
+		return result.val;
+	}
+
+	/**
+	 * log( n! ) - ( ( n + 1/2 ) log( n ) - n + log( 2 pi ) / 2 ), the error
+	 * of Stirling's formula, for whole numbers <n> of at least 1
+	 */
+	static double StirlingError( double n )
+	{
+		static const double TABLE[] = {
+			0.0, 0.0810614667953272582196702, 0.0413406959554092940938221,
+			0.02767792568499833914878929, 0.02079067210376509311152277, 0.01664469118982119216319487,
+			0.01387612882307074799874573, 0.01189670994589177009505572, 0.010411265261972096497478567,
+			0.009255462182712732917728637, 0.008330563433362871256469318, 0.007573675487951840794972024,
+			0.006942840107209529865664152, 0.006408994188004207068439631, 0.005951370112758847735624416,
+			0.005554733551962801371038690
+		};
+		static const double S0 = 1.0 / 12, S1 = 1.0 / 360, S2 = 1.0 / 1260, S3 = 1.0 / 1680, S4 = 1.0 / 1188;
+		if( n <= 15 )
+		{
+			return TABLE[ static_cast< int >( n ) ];
+		}
+		double nn = n * n;
+		if( n > 500 )
+		{
+			return ( S0 - S1 / nn ) / n;
+		}
+		if( n > 80 )
+		{
+			return ( S0 - ( S1 - S2 / nn ) / nn ) / n;
+		}
+		if( n > 35 )
+		{
+			return ( S0 - ( S1 - ( S2 - S3 / nn ) / nn ) / nn ) / n;
+		}
+		return ( S0 - ( S1 - ( S2 - ( S3 - S4 / nn ) / nn ) / nn ) / nn ) / n;
+	}
+
+	/**
+	 * x log( x / np ) + np - x, without the cancellation of computing it so
+	 * when x is close to np
+	 */
+	static double Deviance( double x, double np )
+	{
+		if( std::fabs( x - np ) < 0.1 * ( x + np ) )
+		{
+			double v = ( x - np ) / ( x + np );
+			double s = ( x - np ) * v;
+			double ej = 2 * x * v;
+			v *= v;
+			for( int j = 1; j < 1000; j++ )
+			{
+				ej *= v;
+				double s1 = s + ej / ( 2 * j + 1 );
+				if( s1 == s )
+				{
+					return s1;
+				}
+				s = s1;
+			}
+			return s;
+		}
+		return x * std::log( x / np ) + np - x;
+	}
+
+	double BinomialUpperTailFast( int k, double n, double p )
+	{
+		double q = 1 - p;
+		if( k <= 0 || k >= n || ! ( p > 0 && p < 1 ) || n != std::floor( n ) )
+		{
+			return BinomialUpperTail( k, n, p );
+		}
+
+		// Each term is the last times ( n - j ) / ( j + 1 ) p / q, which only
+		// shrinks past j = k; near the middle of the distribution, leave it to GSL
+		double odds = p / q;
+		double ratio = ( n - k ) / ( k + 1 ) * odds;
+		if( ! ( ratio <= 0.5 ) )
+		{
+			return BinomialUpperTail( k, n, p );
+		}
+
+		// log P(X = k), as dbinom computes it, then the sum of the tail
+		// relative to that term
+		double logTerm = StirlingError( n ) - StirlingError( k ) - StirlingError( n - k )
+			- Deviance( k, n * p ) - Deviance( n - k, n * q )
+			- 0.5 * ( std::log( 2 * M_PI ) + std::log( static_cast< double >( k ) ) + std::log1p( -k / n ) );
+		double sum = 1.0;
+		double term = 1.0;
+		for( double j = k; j < n; j++ )
+		{
+			term *= ( n - j ) / ( j + 1 ) * odds;
+			double next = sum + term;
+			if( next == sum )
+			{
+				break;
+			}
+			sum = next;
+		}
+		double logTail = logTerm + std::log( sum );
+		if( logTail < std::log( DBL_MIN ) )
+		{
+			return 0.0; // as GSL reports underflow
+		}
+		return std::exp( logTail );
+	}
+}
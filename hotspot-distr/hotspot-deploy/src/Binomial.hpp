@@ -0,0 +1,38 @@
+/**
+ * File: Binomial.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  Upper tails of the binomial distribution, the p-values of hotspots.
+ *  P(X >= k) for X ~ B(n, p) is the regularized incomplete beta function
+ *  I_p(k, n - k + 1), which GSL evaluates by continued fraction.  Far
+ *  enough into the upper tail, where hotspots are, the terms of the
+ *  distribution fall off geometrically from the k-th on, and a few dozen
+ *  of them sum to the tail faster, starting from the k-th term computed
+ *  as R's dbinom does (Loader, "Fast and accurate computation of
+ *  binomial probabilities", 2000).
+ */
+
+#ifndef BINOMIAL_HPP_
+#define BINOMIAL_HPP_
+
+namespace hotspot
+{
+
+	/**
+	 * Binomial P(X >= k) for X ~ B(n, p), from GSL: 0 if it underflows, and
+	 * 1 for any other GSL error
+	 */
+	double BinomialUpperTail( int k, double n, double p );
+
+	/**
+	 * BinomialUpperTail( ), by summing the terms of the tail where they fall
+	 * off at least by half from one to the next, and from GSL elsewhere
+	 */
+	double BinomialUpperTailFast( int k, double n, double p );
+
+} // namespace hotspot
+
+#endif /* BINOMIAL_HPP_ */
@@ -11,43 +11,697 @@
  *   of the clustering calculation functions.  Consider Hotspot.hpp
  *   for details on the global variables.  All global variables are
  *   storage for program input parameters.
+ *
+ *   Built with HOTSPOT_NO_MAIN defined, main( ) is left out, so that
+ *   hotspot-bench can run the clustering stages on their own.
  */
 
 #include <cstdio>
 #include <cmath>
 #include <cstring>
 #include <cstdlib>
+#include <climits>
 #include <unistd.h>
 #include <iostream>
+#include <sstream>
 #include <map>
+#include <algorithm>
+#include <pthread.h>
 
 extern "C"
 {
-	#include <gsl/gsl_sf_gamma.h>
 	#include <gsl/gsl_errno.h>
 }
 
+#include "Binomial.hpp"
 #include "Cluster.hpp"
+#include "HotspotBed.hpp"
 #include "HotspotDefaults.hpp"
 #include "Hotspot.hpp"
+#include "HotspotTable.hpp"
 #include "InputDataReader.hpp"
+#include "IntervalSet.hpp"
 #include "MappableCountsDataReader.hpp"
+#include "OrderedOutput.hpp"
+#include "Rescore.hpp"
+#include "RunStats.hpp"
+#include "ThreadPool.hpp"
 
 namespace hotspot
 {
+	int totaltagcount, densityWin;
+	int lowInt, highInt, incInt;
+	double numSD, genomeSize;
+	std::string outputFileName;
+	FILE *fpout;
+
 	std::string densitypath = HotspotDefaults::DENSITY_PATH;
 	std::string libpath = hotspot::HotspotDefaults::LIB_PATH;
+	std::vector< std::string > libPaths; // every -i, in order; libpath is the first
+	std::vector< std::FILE* > fpouts; // every -o, in order; fpout is the first
 	int densityWinSmall = HotspotDefaults::DENSITY_WIN_SMALL;
 	bool useGenomeDensWin = HotspotDefaults::USE_GENOME_DENS_WIN; // flag to use alternate density window if it gives a lower z-score
-	int numGenomeDens, numLocalDens;
-	double genomeDensZ, localDensZ;
 	double mpblGenomeSize = HotspotDefaults::MAPPABLE_GENOME_SIZE;
 	bool useDefaultBackgroundTags = HotspotDefaults::USE_DEFAULT_BACKGROUND_TAGS; // flag to determine what tag count to use for z-score genome-wide background calculations
-	bool useFuzzyThreshold = HotspotDefaults::USE_FUZZY_THRESHOLD;
+	bool printPValues = false; // -pvals: binomial p-value columns in the output
 	int backgroundTotalTagCount;
+	int numThreads = HotspotDefaults::NUM_THREADS;
+	int libTagCount = -1; // total tags in the library, if given with -tagcount
+	ThreadPool* threadPool = NULL; // shared by all stages in -threads mode
+	std::FILE* fpoutPassTwo = NULL; // -twopass output
+	std::string mappableRegionsPath; // uniquely mappable regions, for the pass-2 background
+	int passTwoMinSize = HotspotDefaults::PASS2_MIN_SIZE;
+	double passTwoZThresh = HotspotDefaults::PASS2_Z_THRESH;
+	int passTwoMergeDist = HotspotDefaults::PASS2_MERGE_DIST;
+	std::string outputPath; // -o
+	std::string rescorePassOnePath; // -rescore: hotspots of each pass
+	std::string rescorePassTwoPath;
+	std::string backgroundTagsPath; // pass-2 background tags and regions, for -rescore
+	std::string backgroundRegionsPath;
+	std::string inputTagsPath; // input tags to subtract in -rescore mode
+	std::FILE* fppval = NULL; // -rescore p-value output
+	std::FILE* fpspot = NULL; // -rescore SPOT output
+	std::vector< std::FILE* > fpbeds; // every -bed, in the order of the -o files
+	std::vector< std::FILE* > fpwigs; // every -wig, likewise
+	std::vector< std::string > wigTracks; // the track name of each -wig
+	std::vector< HotspotBed* > hotspotBeds; // for each -o file, with -bed or -wig
+	std::string statsPath; // -stats
+	RunStats* runStats = NULL; // collects the -stats report, if there is one
+
+	/**
+	 * Working storage for the chromosomes in progress in -threads mode.  An arena
+	 * is reused by later chromosomes once its chromosome is done.
+	 */
+	class ArenaPool
+	{
+	public:
+		ArenaPool( )
+		{
+			pthread_mutex_init( &_lock, NULL );
+		}
+
+		~ArenaPool( )
+		{
+			// Every arena is back by now, and an arena never shrinks, so
+			// together they are the most storage the pool ever held
+			long long bytes = 0;
+			for( unsigned int i = 0; i < _free.size( ); i++ )
+			{
+				bytes += _free[i]->bytes( );
+				delete _free[i];
+			}
+			if( runStats != NULL )
+			{
+				runStats->noteArenaBytes( bytes );
+			}
+			pthread_mutex_destroy( &_lock );
+		}
+
+		HotspotArena* acquire( )
+		{
+			HotspotArena* arena = NULL;
+			pthread_mutex_lock( &_lock );
+			if( ! _free.empty( ) )
+			{
+				arena = _free.back( );
+				_free.pop_back( );
+			}
+			pthread_mutex_unlock( &_lock );
+			return arena != NULL ? arena : new HotspotArena;
+		}
+
+		void release( HotspotArena* arena )
+		{
+			pthread_mutex_lock( &_lock );
+			_free.push_back( arena );
+			pthread_mutex_unlock( &_lock );
+		}
+
+	private:
+		pthread_mutex_t _lock;
+		std::vector< HotspotArena* > _free;
+	};
+
+	/**
+	 * The -bed and -wig hotspots of library <library>, or NULL if there are none
+	 */
+	HotspotBed* LibraryBed( unsigned int library )
+	{
+		return ( library < hotspotBeds.size( ) ) ? hotspotBeds[ library ] : NULL;
+	}
+
+	/**
+	 * Add the hotspots of one pass-1 chromosome that pass 2 is built around to
+	 * <merged>: those at least passTwoMinSize wide with a finite z-score above
+	 * passTwoZThresh, then merged if within passTwoMergeDist of each other.
+	 * This is the selection run_pass1_merge_and_thresh_hotspots makes from the
+	 * output file, so the z-score is compared as printed there.
+	 */
+	void SelectPassOneHotspots( const HotspotTable& clusters, IntervalSet& merged )
+	{
+		int pad = passTwoMergeDist / 2;
+		merged.clear( );
+		for( int i = 0; i < clusters.size( ); i++ )
+		{
+			char zText[64];
+			std::snprintf( zText, sizeof( zText ), "%f", clusters.filteredZScoreAdjusted[i] );
+			double z = std::strtod( zText, NULL );
+			if( clusters.maxSite[i] - clusters.minSite[i] + 1 < passTwoMinSize
+				|| ! ( z > passTwoZThresh ) || std::isinf( z ) )
+			{
+				continue;
+			}
+			merged.add( clusters.minSite[i], clusters.maxSite[i] + 1 );
+		}
+		merged.pad( pad );
+		merged.shrink( pad );
+	}
+
+	/**
+	 * One chromosome of work in -threads mode.  Results are kept in memory
+	 * until every chromosome ahead of this one in the input has been written.
+	 */
+	class ChromTask : public ThreadPool::Task
+	{
+	public:
+		int chunk; // position of this chromosome in the input
+		std::string chromName;
+		std::vector< int > inputData;
+		const std::vector< int >* mappableCounts; // shared by every library with this chromosome
+		TagCounts counts;
+		OrderedOutput* output;
+		ArenaPool* arenas;
+		IntervalSet* passOneHotspots; // in -twopass mode, collects the hotspots kept for pass 2
+		HotspotBed* bed; // collects the -bed and -wig hotspots, if there are any
+		ChromStats stats; // for the -stats report
+
+		ChromTask( ) : chunk( 0 ), mappableCounts( NULL ), output( NULL ), arenas( NULL ), passOneHotspots( NULL ),
+					   bed( NULL )
+		{
+			counts.total = 0;
+			counts.background = 0;
+		}
+
+		void run( )
+		{
+			char* buf = NULL;
+			size_t len = 0;
+			std::FILE* fp = open_memstream( &buf, &len );
+			if( fp == NULL )
+			{
+				std::cerr << "Error: unable to allocate output buffer for " << chromName << std::endl;
+				std::exit( EXIT_FAILURE );
+			}
+			std::ostringstream log;
+			log << "Processing chrom: " << chromName << std::endl;
+			HotspotArena* arena = arenas->acquire( );
+			ProcessChrom( chromName, inputData, *mappableCounts, counts, *arena, fp, log,
+						  ( runStats != NULL ) ? &stats : NULL );
+			if( passOneHotspots != NULL )
+			{
+				SelectPassOneHotspots( arena->clusters, *passOneHotspots );
+			}
+			if( bed != NULL )
+			{
+				bed->add( chunk, chromName, arena->clusters, 0, arena->clusters.size( ) );
+			}
+			arenas->release( arena );
+			std::fclose( fp );
+
+			std::string data( buf, len );
+			std::free( buf );
+			std::string logText = log.str( );
+			if( passOneHotspots == NULL )
+			{
+				std::vector< int >( ).swap( inputData );
+			}
+			if( runStats != NULL )
+			{
+				runStats->addChrom( stats );
+			}
+			output->complete( chunk, data, logText );
+		}
+	};
+
+	/**
+	 * Set the total tag count used by every window threshold, and report it.
+	 * The pipeline scripts read the count back from standard output.
+	 */
+	void SetTotalTagCount( int count )
+	{
+		totaltagcount = count;
+		std::cout << "TotalTagCount: " << totaltagcount << std::endl;
+		if( useDefaultBackgroundTags )
+		{
+			backgroundTotalTagCount = totaltagcount;
+		}
+	}
+
+	/**
+	 * The tag counts set by SetTotalTagCount( ) and -bckntags
+	 */
+	TagCounts CurrentTagCounts( )
+	{
+		TagCounts counts;
+		counts.total = totaltagcount;
+		counts.background = backgroundTotalTagCount;
+		return counts;
+	}
+
+	// Orders chromosomes largest first, for scheduling
+	bool moreTags( const ChromTask* a, const ChromTask* b )
+	{
+		return a->inputData.size( ) > b->inputData.size( );
+	}
+
+	/**
+	 * Process the chromosomes one at a time, as they are read
+	 */
+	int ProcessChromsSerial( InputDataReader& inputDataReader, MappableCountsDataReader& mappableCountsDataReader )
+	{
+		bool headerPrinted = false;
+		int numTagsRead = 0;
+		std::vector< int > inputData;
+		std::vector< int > mappableCounts;
+		HotspotArena arena; // reused by every chromosome
+		HotspotBed* bed = LibraryBed( 0 );
+		ChromStats stats;
+		int numChroms = 0;
+		StageClock clock( ( runStats != NULL ) ? &stats : NULL );
+
+		// Main processing loop: each pass considers each chromosome in the input data set
+		int numTags;
+		while( ( numTags = inputDataReader.readNextChrom( inputData ) ) > 0 )
+		{
+			numTagsRead += numTags;
+			std::cerr << "Processing chrom: " << inputDataReader.currentChromName( ) << std::endl;
+
+			// get counts of 'background' mappable K-mers on each 50kb interval on that chromosome
+			int numRead = mappableCountsDataReader.readChrom(inputDataReader.currentChromName( ), mappableCounts );
+			if( numRead < 0 )
+			{
+				std::cerr << "Error reading background file. Aborting" << std::endl;
+				exit( EXIT_FAILURE );
+			}
+
+			if(! headerPrinted )
+			{
+				Hotspot::printHeader( fpout, printPValues, printPValues && useGenomeDensWin );
+				headerPrinted = true;
+			}
+			clock.lap( STAGE_READ );
+			ProcessChrom( inputDataReader.currentChromName( ), inputData, mappableCounts, CurrentTagCounts( ),
+						  arena, fpout, std::cerr, ( runStats != NULL ) ? &stats : NULL );
+			if( bed != NULL )
+			{
+				bed->add( numChroms, inputDataReader.currentChromName( ), arena.clusters, 0, arena.clusters.size( ) );
+			}
+			numChroms++;
+			mappableCounts.clear( );
+			inputData.clear( );
+			if( runStats != NULL )
+			{
+				runStats->addChrom( stats );
+				stats = ChromStats( );
+				stats.order = numChroms;
+			}
+			clock.start( );
+		}  // end loop over all chromosomes
+
+		if( numTags < 0 )
+		{
+			exit( EXIT_FAILURE ); // malformed input, already reported
+		}
+		if( runStats != NULL )
+		{
+			runStats->noteArenaBytes( arena.bytes( ) );
+		}
+		return numTagsRead;
+	}
+
+	/**
+	 * Read every chromosome into <tasks>.  Background counts are read into
+	 * <background> the first time a chromosome is seen, and shared by every
+	 * task for it.  Returns the number of tags read.
+	 */
+	int ReadAllChroms( InputDataReader& inputDataReader, MappableCountsDataReader& mappableCountsDataReader,
+					   std::map< std::string, std::vector< int > >& background, std::vector< ChromTask* >& tasks )
+	{
+		int numTagsRead = 0;
+		while( true )
+		{
+			ChromTask* task = new ChromTask;
+			StageClock clock( ( runStats != NULL ) ? &task->stats : NULL );
+			int numTags = inputDataReader.readNextChrom( task->inputData );
+			if( numTags <= 0 )
+			{
+				delete task;
+				if( numTags < 0 )
+				{
+					exit( EXIT_FAILURE ); // malformed input, already reported
+				}
+				break;
+			}
+			numTagsRead += numTags;
+			task->chunk = tasks.size( );
+			task->chromName = inputDataReader.currentChromName( );
+			std::map< std::string, std::vector< int > >::iterator counts = background.find( task->chromName );
+			if( counts == background.end( ) )
+			{
+				counts = background.insert( std::make_pair( task->chromName, std::vector< int >( ) ) ).first;
+				int numRead = mappableCountsDataReader.readChrom( task->chromName, counts->second );
+				if( numRead < 0 )
+				{
+					std::cerr << "Error reading background file. Aborting" << std::endl;
+					exit( EXIT_FAILURE );
+				}
+			}
+			task->mappableCounts = &counts->second;
+			task->stats.order = task->chunk;
+			clock.lap( STAGE_READ );
+			tasks.push_back( task );
+		}
+		return numTagsRead;
+	}
+
+	/**
+	 * Process <tasks>, each with its output and tag counts set, on a pool of
+	 * numThreads threads, largest first
+	 */
+	void ScheduleChromTasks( const std::vector< ChromTask* >& tasks )
+	{
+		ArenaPool arenas;
+		std::vector< ChromTask* > schedule( tasks );
+		std::stable_sort( schedule.begin( ), schedule.end( ), moreTags );
+
+		ThreadPool pool( numThreads );
+		threadPool = &pool;
+		ThreadPool::TaskGroup group;
+		for( unsigned int i = 0; i < schedule.size( ); i++ )
+		{
+			schedule[i]->arenas = &arenas;
+			pool.submit( schedule[i], group );
+		}
+		pool.wait( group );
+		threadPool = NULL;
+	}
+
+	/**
+	 * Process <tasks> on a pool of numThreads threads, largest first.  Output
+	 * is written to <out> in input order, identical to a serial run.
+	 */
+	void RunChromTasks( const std::vector< ChromTask* >& tasks, std::FILE* out )
+	{
+		if( tasks.empty( ) )
+		{
+			return;
+		}
+
+		Hotspot::printHeader( out, printPValues, printPValues && useGenomeDensWin );
+		OrderedOutput output( out, tasks.size( ) );
+		TagCounts counts = CurrentTagCounts( );
+		for( unsigned int i = 0; i < tasks.size( ); i++ )
+		{
+			tasks[i]->output = &output;
+			tasks[i]->counts = counts;
+		}
+		ScheduleChromTasks( tasks );
+	}
+
+	/**
+	 * Read every chromosome, then process them on a pool of numThreads threads.
+	 * If the total tag count is not yet known, it is set from the tags read.
+	 */
+	int ProcessChromsThreaded( InputDataReader& inputDataReader, MappableCountsDataReader& mappableCountsDataReader,
+							   bool haveTagCount )
+	{
+		std::map< std::string, std::vector< int > > mappableCounts;
+		std::vector< ChromTask* > tasks;
+		int numTagsRead = ReadAllChroms( inputDataReader, mappableCountsDataReader, mappableCounts, tasks );
+		if( ! haveTagCount )
+		{
+			SetTotalTagCount( numTagsRead );
+		}
+		for( unsigned int i = 0; i < tasks.size( ); i++ )
+		{
+			tasks[i]->bed = LibraryBed( 0 );
+		}
+		RunChromTasks( tasks, fpout );
+
+		for( unsigned int i = 0; i < tasks.size( ); i++ )
+		{
+			delete tasks[i];
+		}
+		return numTagsRead;
+	}
+
+	/**
+	 * Exit with an error unless <numTagsRead> is the total tag count of <path>
+	 */
+	void CheckTagsRead( int numTagsRead, const std::string& path = libpath )
+	{
+		if( numTagsRead != totaltagcount )
+		{
+			std::fprintf( stderr, "Error: expected %d tags in %s, but read %d\n",
+					totaltagcount, path.c_str( ), numTagsRead );
+			std::exit( EXIT_FAILURE );
+		}
+	}
+
+	/**
+	 * Several -i/-o pairs in one run, such as a library and its size-matched
+	 * random library.  The background counts are read once, for all of them,
+	 * and every chromosome of every library is processed on one pool of
+	 * numThreads threads, largest first, so the small chromosomes of one
+	 * library keep threads busy alongside the large ones of another.  Each
+	 * library has its own tag counts, and each output file is identical to a
+	 * run on that library alone.
+	 */
+	void ProcessLibraries( MappableCountsDataReader& mappableCountsDataReader )
+	{
+		std::map< std::string, std::vector< int > > mappableCounts;
+		std::vector< ChromTask* > tasks;
+		std::vector< OrderedOutput* > outputs;
+		for( unsigned int l = 0; l < libPaths.size( ); l++ )
+		{
+			InputDataReader inputDataReader( libPaths[l] );
+			if( ! inputDataReader.isRegularFile( ) )
+			{
+				std::cerr << "Error: each of several -i files must be a regular file; " << libPaths[l] << " is not" << std::endl;
+				std::exit( EXIT_FAILURE );
+			}
+			int tagCount;
+			bool haveTagCount = inputDataReader.tagCount( tagCount );
+			std::vector< ChromTask* > libraryTasks;
+			int numTagsRead = ReadAllChroms( inputDataReader, mappableCountsDataReader, mappableCounts, libraryTasks );
+			SetTotalTagCount( haveTagCount ? tagCount : numTagsRead );
+			CheckTagsRead( numTagsRead, libPaths[l] );
+			if( runStats != NULL )
+			{
+				runStats->addInput( libPaths[l], inputDataReader.bytesParsed( ), inputDataReader.linesParsed( ) );
+			}
+
+			if( libraryTasks.empty( ) )
+			{
+				continue;
+			}
+			Hotspot::printHeader( fpouts[l], printPValues, printPValues && useGenomeDensWin );
+			outputs.push_back( new OrderedOutput( fpouts[l], libraryTasks.size( ) ) );
+			TagCounts counts = CurrentTagCounts( );
+			for( unsigned int i = 0; i < libraryTasks.size( ); i++ )
+			{
+				libraryTasks[i]->output = outputs.back( );
+				libraryTasks[i]->counts = counts;
+				libraryTasks[i]->stats.library = l;
+				libraryTasks[i]->bed = LibraryBed( l );
+			}
+			tasks.insert( tasks.end( ), libraryTasks.begin( ), libraryTasks.end( ) );
+		}
+
+		ScheduleChromTasks( tasks );
+
+		for( unsigned int i = 0; i < outputs.size( ); i++ )
+		{
+			delete outputs[i];
+		}
+		for( unsigned int i = 0; i < tasks.size( ); i++ )
+		{
+			delete tasks[i];
+		}
+	}
+
+	/**
+	 * -twopass mode: the first and second passes of the pipeline scripts in one
+	 * run.  Pass 1 is an ordinary run, written to the -o file.  Its hotspots
+	 * that pass the pass-2 size and z-score thresholds are merged, padded by
+	 * the background window on each side, and subtracted from the padding; the
+	 * result, restricted to the -mappable regions, is the pass-2 background.
+	 * Pass 2 runs on the tags that fall in it, which are taken from the pass-1
+	 * tags in place, and is written to the -twopass file.
+	 */
+	void ProcessChromsTwoPass( InputDataReader& inputDataReader, MappableCountsDataReader& mappableCountsDataReader,
+							   bool haveTagCount )
+	{
+		std::map< std::string, std::vector< int > > mappableCounts;
+		std::vector< ChromTask* > tasks;
+		int numTagsRead = ReadAllChroms( inputDataReader, mappableCountsDataReader, mappableCounts, tasks );
+		if( ! haveTagCount )
+		{
+			SetTotalTagCount( numTagsRead );
+		}
+		CheckTagsRead( numTagsRead );
+
+		// Pass 1, as run_pass1_hotspot runs it: with the tags read as
+		// background tag count.  -bckntags applies to pass 2.
+		std::map< std::string, IntervalSet > background;
+		for( unsigned int i = 0; i < tasks.size( ); i++ )
+		{
+			tasks[i]->passOneHotspots = &background[ tasks[i]->chromName ];
+			tasks[i]->bed = LibraryBed( 0 );
+		}
+		int passTwoBackgroundTags = backgroundTotalTagCount;
+		backgroundTotalTagCount = totaltagcount;
+		RunChromTasks( tasks, fpout );
+
+		// The pass-2 background, built chromosome by chromosome from the merged hotspots
+		std::map< std::string, IntervalSet >::iterator chrom;
+		for( chrom = background.begin( ); chrom != background.end( ); ++chrom )
+		{
+			IntervalSet hotspots( chrom->second );
+			chrom->second.pad( densityWin );
+			chrom->second.subtract( hotspots );
+		}
+		if( ! IntersectWithBed( mappableRegionsPath, background ) )
+		{
+			std::exit( EXIT_FAILURE );
+		}
+
+		// Keep only the tags in the background, moving them down in place
+		int numPassTwoTags = 0;
+		std::vector< ChromTask* > passTwo;
+		for( unsigned int i = 0; i < tasks.size( ); i++ )
+		{
+			ChromTask* task = tasks[i];
+			ChromStats passTwoStats;
+			passTwoStats.pass = 2;
+			passTwoStats.order = task->stats.order;
+			StageClock clock( ( runStats != NULL ) ? &passTwoStats : NULL );
+			std::vector< std::pair< int, int > > ranges;
+			background[ task->chromName ].selectTags( task->inputData, ranges );
+			int numKept = 0;
+			for( unsigned int r = 0; r < ranges.size( ); r++ )
+			{
+				std::copy( task->inputData.begin( ) + ranges[r].first, task->inputData.begin( ) + ranges[r].second,
+						   task->inputData.begin( ) + numKept );
+				numKept += ranges[r].second - ranges[r].first;
+			}
+			task->inputData.resize( numKept );
+			task->passOneHotspots = NULL;
+			task->bed = NULL;
+			clock.lap( STAGE_READ );
+			task->stats = passTwoStats;
+			if( numKept > 0 )
+			{
+				task->chunk = passTwo.size( );
+				passTwo.push_back( task );
+				numPassTwoTags += numKept;
+			}
+		}
+
+		// Pass 2, as run_pass2_hotspot runs it: by default the background tag
+		// count is the pass-1 count, to the nearest 100000
+		totaltagcount = numPassTwoTags;
+		std::cerr << "Pass 2 TotalTagCount: " << totaltagcount << std::endl;
+		if( useDefaultBackgroundTags )
+		{
+			passTwoBackgroundTags = ( ( numTagsRead + 50000 ) / 100000 ) * 100000;
+		}
+		backgroundTotalTagCount = passTwoBackgroundTags;
+		RunChromTasks( passTwo, fpoutPassTwo );
+
+		for( unsigned int i = 0; i < tasks.size( ); i++ )
+		{
+			delete tasks[i];
+		}
+	}
+
+	/**
+	 * -rescore mode: re-score the hotspots of both passes in place of
+	 * run_rescore_hotspot_passes.  The z-score track is named for the -o file.
+	 */
+	void RescoreBothPasses( )
+	{
+		RescoreParams params;
+		params.passOneFileName = rescorePassOnePath;
+		params.passTwoFileName = rescorePassTwoPath;
+		params.backgroundTagsFileName = backgroundTagsPath;
+		params.backgroundRegionsFileName = backgroundRegionsPath;
+		params.mappableRegionsFileName = mappableRegionsPath;
+		params.inputTagsFileName = inputTagsPath;
+		if( fpspot != NULL )
+		{
+			params.spotTagsFileName = libpath;
+		}
+		params.minSize = passTwoMinSize;
+		params.zThresh = passTwoZThresh;
+		params.densityWin = densityWin;
+		params.numTags = backgroundTotalTagCount;
+		params.mappableGenomeSize = mpblGenomeSize;
+		params.numThreads = numThreads;
+
+		std::string::size_type slash = outputPath.rfind( '/' );
+		params.trackName = ( slash == std::string::npos ) ? outputPath : outputPath.substr( slash + 1 );
+		if( params.trackName.size( ) > 4 && params.trackName.compare( params.trackName.size( ) - 4, 4, ".wig" ) == 0 )
+		{
+			params.trackName.erase( params.trackName.size( ) - 4 );
+		}
+
+		if( ! RescoreHotspots( params, fpout, fppval, fpspot ) )
+		{
+			std::exit( EXIT_FAILURE );
+		}
+	}
+
+	/**
+	 * Write and close the -bed and -wig files
+	 */
+	void WriteHotspotBeds( )
+	{
+		for( unsigned int l = 0; l < hotspotBeds.size( ); l++ )
+		{
+			if( l < fpbeds.size( ) )
+			{
+				if( ! hotspotBeds[l]->write( fpbeds[l], "" ) )
+				{
+					std::exit( EXIT_FAILURE );
+				}
+				std::fclose( fpbeds[l] );
+			}
+			if( l < fpwigs.size( ) )
+			{
+				if( ! hotspotBeds[l]->write( fpwigs[l], wigTracks[l] ) )
+				{
+					std::exit( EXIT_FAILURE );
+				}
+				std::fclose( fpwigs[l] );
+			}
+		}
+	}
+
+	/**
+	 * Write the -stats report, if there is one
+	 */
+	void WriteRunStats( )
+	{
+		if( runStats != NULL && ! runStats->write( statsPath, numThreads ) )
+		{
+			std::exit( EXIT_FAILURE );
+		}
+	}
 
 } // namespace
 
+#ifndef HOTSPOT_NO_MAIN
 int main( int argc, char **argv )
 {
     // We use a GSL special function to compute binomial cdfs.  
@@ -59,393 +713,920 @@ int main( int argc, char **argv )
     hotspot::lowInt = hotspot::HotspotDefaults::LOW_INTERVAL_WIDTH;   // range and interval for scanning
     hotspot::highInt = hotspot::HotspotDefaults::HIGH_INTEVAL_WIDTH;
     hotspot::incInt = hotspot::HotspotDefaults::INTERVAL_INCREMENT;
-	hotspot::fuzzySeed = hotspot::HotspotDefaults::FUZZY_SEED;
     hotspot::totaltagcount = 0;
     hotspot::densityWin = hotspot::HotspotDefaults::DENSITY_WIN;
 
 	// Fetch input data
 	hotspot::GetArgs( argc, argv);
+	hotspot::genomeSize = hotspot::mpblGenomeSize; // RET:  changed from EDH's value of 3.0E9
+	if( ! hotspot::rescorePassOnePath.empty( ) )
+	{
+		hotspot::RescoreBothPasses( );
+		std::fclose( hotspot::fpout );
+		std::fclose( hotspot::fppval );
+		if( hotspot::fpspot != NULL )
+		{
+			std::fclose( hotspot::fpspot );
+		}
+		hotspot::WriteRunStats( );
+		std::exit( EXIT_SUCCESS );
+	}
+	if( hotspot::libPaths.size( ) > 1 )
+	{
+		hotspot::MappableCountsDataReader mappableCountsDataReader( hotspot::densitypath );
+		hotspot::ProcessLibraries( mappableCountsDataReader );
+		for( unsigned int l = 0; l < hotspot::fpouts.size( ); l++ )
+		{
+			std::fclose( hotspot::fpouts[l] );
+		}
+		hotspot::WriteHotspotBeds( );
+		hotspot::WriteRunStats( );
+		std::exit( EXIT_SUCCESS );
+	}
 	hotspot::InputDataReader inputDataReader( hotspot::libpath );
-	hotspot::totaltagcount = inputDataReader.numLines( );
-	std::cout << "TotalTagCount: " << hotspot::totaltagcount << std::endl;
+
+	// A library that is not a regular file, such as standard input or a named
+	// pipe, is streamed: read once, with only a window of tags held at a time.
+	bool streaming = ! inputDataReader.isRegularFile( );
+
+	// Every window threshold depends on the total tag count, so it must be known
+	// before the first chromosome is processed.  Take it from -tagcount, or else
+	// the library's .counts file if there is one.  Otherwise -threads mode, which
+	// reads the whole library before processing, counts the tags as it goes; only
+	// a serial run needs a separate pass over the library to count them.
+	int tagCount = hotspot::libTagCount;
+	bool haveTagCount = ( tagCount >= 0 ) || inputDataReader.tagCount( tagCount );
+	if( streaming && hotspot::fpoutPassTwo != NULL )
+	{
+		std::cerr << "Error: -twopass needs every tag in memory; " << hotspot::libpath << " is not a regular file" << std::endl;
+		std::exit( EXIT_FAILURE );
+	}
+	if( ! haveTagCount && streaming )
+	{
+		std::cerr << "Error: -tagcount is required to read " << hotspot::libpath << ", which is not a regular file" << std::endl;
+		std::exit( EXIT_FAILURE );
+	}
+	if( ! haveTagCount && hotspot::numThreads <= 1 && hotspot::fpoutPassTwo == NULL )
+	{
+		tagCount = inputDataReader.numLines( );
+		haveTagCount = true;
+	}
+	if( haveTagCount )
+	{
+		hotspot::SetTotalTagCount( tagCount );
+	}
 	hotspot::MappableCountsDataReader mappableCountsDataReader( hotspot::densitypath );
-	if( hotspot::useDefaultBackgroundTags )
+
+	if( hotspot::fpoutPassTwo != NULL )
 	{
-		hotspot::backgroundTotalTagCount = hotspot::totaltagcount;
+		hotspot::ProcessChromsTwoPass( inputDataReader, mappableCountsDataReader, haveTagCount );
 	}
-    if( hotspot::useFuzzyThreshold )
+	else if( streaming )
+	{
+		hotspot::CheckTagsRead( hotspot::ProcessChromsStreaming( inputDataReader, mappableCountsDataReader ) );
+	}
+	else if( hotspot::numThreads > 1 )
+	{
+		hotspot::CheckTagsRead( hotspot::ProcessChromsThreaded( inputDataReader, mappableCountsDataReader, haveTagCount ) );
+	}
+	else
+	{
+		hotspot::CheckTagsRead( hotspot::ProcessChromsSerial( inputDataReader, mappableCountsDataReader ) );
+	}
+
+	// Release open resources
+    if( hotspot::fpout )
     {
-    	std::srand( hotspot::fuzzySeed );
-    }
+    	std::fclose( hotspot::fpout );
+	}
+    if( hotspot::fpoutPassTwo )
+    {
+    	std::fclose( hotspot::fpoutPassTwo );
+	}
+	hotspot::WriteHotspotBeds( );
+	if( hotspot::runStats != NULL )
+	{
+		hotspot::runStats->addInput( hotspot::libpath, inputDataReader.bytesParsed( ), inputDataReader.linesParsed( ) );
+	}
+	hotspot::WriteRunStats( );
+
+    std::exit( EXIT_SUCCESS );
+}
+#endif // HOTSPOT_NO_MAIN
+
+namespace hotspot
+{
+
+	void ProcessChrom( const std::string& chromName, const std::vector< int >& inputData,
+					   const std::vector< int >& mappableCounts, const TagCounts& counts,
+					   HotspotArena& arena, std::FILE* out, std::ostream& log, ChromStats* stats )
+	{
+		StageClock clock( stats );
+		arena.clear( );
+		HotspotTable& hotspots = arena.candidates;
+		HotspotTable& filteredHotspots = arena.clusters;
+
+		// Compute the hot spots and filter them
+		log << "Compute Hot Spots " << std::endl;
+		ComputeHotSpots( inputData, lowInt, highInt, incInt, counts.total, hotspots );
+		clock.lap( STAGE_SWEEP );
+		log << "Completing HotSpot Identification" << std::endl;
+		log << "Filter Hot Spots " << std::endl;
+		FilterHotspots( hotspots, filteredHotspots );
+		clock.lap( STAGE_FILTER );
+
+		// Calculate cluster size, and other hotspot statistics
+		DensityWindowStats densStats;
+		log << "Cluster Size" << std::endl;
+		ClusterSize( inputData, densityWin, filteredHotspots, mappableCounts, counts.background, densStats, log );
+		clock.lap( STAGE_CLUSTER );
+
+		if( useGenomeDensWin )
+		{
+			log << densStats.numGenomeDens
+				<< " clusters scored using genome-wide density, avg. z = "
+				<< densStats.genomeDensZ / densStats.numGenomeDens
+				<< "; " << densStats.numLocalDens
+				<< " scored using local density, avg. z = "
+				<< densStats.localDensZ / densStats.numLocalDens
+				<< std::endl;
+		}
+
+		// Summarize the results of this chromosome
+		for( int i = 0; i < filteredHotspots.size( ); ++i )
+		{
+			Hotspot::printOut( filteredHotspots, i, chromName, arena.output, printPValues, printPValues && useGenomeDensWin );
+		}
+		arena.output.writeTo( out );
+
+		log << "Chrom summary: " << filteredHotspots.size( ) << std::endl;
+		std::fflush( out );
+		clock.lap( STAGE_WRITE );
+		if( stats != NULL )
+		{
+			stats->chrom = chromName;
+			stats->tags = inputData.size( );
+			stats->candidates = hotspots.size( );
+			stats->hotspots = filteredHotspots.size( );
+		}
+	}
+
+	void ComputeWindowThresholds( int winLow, int winHigh, int winInc, int totalTags,
+								  std::vector< WindowThreshold >& thresholds )
+	{
+		thresholds.clear( );
+		for( int winsize = winLow; winsize <= winHigh; winsize += winInc )
+		{
+			WindowThreshold t;
+			t.winsize = winsize;
+			// A window [pos - winsize/2.0, pos + winsize/2.0] holds exactly the integer
+			// positions within winsize/2 (rounded down) of pos
+			t.halfWidth = winsize / 2;
+			t.prob = winsize / genomeSize;
+			t.mean = t.prob * totalTags;  // RET: adjust for sampling fraction
+			t.sd = std::sqrt(t.prob*(1-t.prob)*totalTags);  // RET: adjust for sampling fraction
+			t.totalTags = totalTags;
+			t.detectThresh = 1 + t.mean + numSD * t.sd;  // includes offset of 1 as we are centering on clones
+
+			// Tag counts are integral, so (count > detectThresh) iff (count >= minCount).
+			// A NaN or huge threshold can never be exceeded.
+			if( t.detectThresh < static_cast< double >( INT_MAX ) )
+			{
+				t.minCount = static_cast< int >( std::floor( t.detectThresh ) ) + 1;
+			}
+			else
+			{
+				t.minCount = INT_MAX;
+			}
+			thresholds.push_back( t );
+		}
+	}
+
+	/**
+	 * Tags in one window size centered on the current tag.  Both edges only move
+	 * forward as the tags are visited in order, so each tag enters and leaves
+	 * the window once.
+	 */
+	struct WindowCursor
+	{
+		unsigned int left;  // first tag in window
+		unsigned int right; // one past last tag in window
+		long long posSum;   // sum of tag positions in window
+
+		WindowCursor( ) : left( 0 ), right( 0 ), posSum( 0 ) { }
+	};
+
+	// A tag whose window of one size exceeded the detection threshold
+	struct WindowHit
+	{
+		unsigned int tag;
+		int averagePos;
+		double currSD;
+	};
+
+	/**
+	 * Center the window of <t> on tag <i>, and report whether it holds enough
+	 * tags for a hotspot.  <disc> is raised to this window's discrepancy.
+	 */
+	inline bool ScoreWindow( const std::vector< int >& inputData, unsigned int i, const WindowThreshold& t,
+							 WindowCursor& cursor, WindowHit& hit, double& disc )
+	{
+		const unsigned int numTags = inputData.size( );
+		const int pos = inputData[i];
+		while( cursor.right < numTags && inputData[cursor.right] <= pos + t.halfWidth )
+		{
+			cursor.posSum += inputData[cursor.right++];
+		}
+		while( inputData[cursor.left] < pos - t.halfWidth )
+		{
+			cursor.posSum -= inputData[cursor.left++];
+		}
+
+		// The current tag is always in its own window
+		int contained = cursor.right - cursor.left;
+
+		double contFrac = contained /(double)t.totalTags; // RET: adjust for sampling fraction
+		double diff = std::fabs(contFrac-t.prob);
+		if (diff > disc) {disc=diff;}
+
+		if( contained < t.minCount )
+		{
+			return false;
+		}
+		// determine number of sd's corresponding to this intensity.
+		// algorithm finds largest window over range containing anomaly.
+		double clonePosAvg = static_cast< double >( cursor.posSum ) / contained;
+		hit.tag = i;
+		hit.averagePos = static_cast< int >(clonePosAvg + 0.5);
+		hit.currSD = (contained - 1 - t.mean) / t.sd;
+		return true;
+	}
+
+	/**
+	 * Scans a block of window sizes over all tags, keeping each size's hits
+	 * in tag order in a private list
+	 */
+	class WindowSweepTask : public ThreadPool::Task
+	{
+	public:
+		const std::vector< int >* inputData;
+		const WindowThreshold* thresholds;
+		std::vector< WindowHit >* hits; // one list per window size in the block
+		double* disc;                   // one per window size in the block
+		unsigned int numWindows;
+
+		void run( )
+		{
+			for( unsigned int w = 0; w < numWindows; w++ )
+			{
+				WindowCursor cursor;
+				WindowHit hit;
+				for( unsigned int i = 0; i < inputData->size( ); i++ )
+				{
+					if( ScoreWindow( *inputData, i, thresholds[w], cursor, hit, disc[w] ) )
+					{
+						hits[w].push_back( hit );
+					}
+				}
+			}
+		}
+	};
+
+	/**
+	 * Window sizes are applied to a tag in increasing order, so the last one
+	 * to qualify sets averagePos and maxWindow
+	 */
+	inline int AddWindowHit( HotspotTable& hotspots, int row, const WindowHit& hit, int winsize )
+	{
+		// Make a new hotspot for this index
+		if( row < 0 )
+		{
+			row = hotspots.appendCandidate( hit.tag );
+		}
+		hotspots.densCount[row] += 1;
+		hotspots.weightedAvgSD[row] += hit.currSD;
+		hotspots.averagePos[row] = hit.averagePos;
+		hotspots.maxWindow[row] = winsize;
+		return row;
+	}
+
+	/**
+	 * Center every window size on tag <i>, in increasing size, and record a
+	 * candidate hotspot for it if any window qualifies.  Returns the candidate's
+	 * row, or -1.
+	 */
+	inline int ScanTag( const std::vector< int >& inputData, unsigned int i,
+						const std::vector< WindowThreshold >& thresholds, std::vector< WindowCursor >& cursors,
+						HotspotTable& hotspots, double& disc )
+	{
+		int row = -1;
+		WindowHit hit;
+		for( unsigned int w = 0; w < thresholds.size( ); w++ )
+		{
+			if( ScoreWindow( inputData, i, thresholds[w], cursors[w], hit, disc ) )
+			{
+				row = AddWindowHit( hotspots, row, hit, thresholds[w].winsize );
+			}
+		}  // over all window sizes
+
+		if( row >= 0 )
+		{
+			hotspots.weightedAvgSD[row] /= hotspots.densCount[row];
+		}
+		return row;
+	}
+
+	double ComputeHotSpots( const std::vector< int>& inputData, int winLow,	int winHigh,
+							int winInc, int totalTags, HotspotTable& hotspots )
+	{
+		/* computes an estimate of the discrepancy using the class
+		   of 1-dimensional intervals of width winLow to winHigh  */
+
+		std::vector< WindowThreshold > thresholds;
+		ComputeWindowThresholds( winLow, winHigh, winInc, totalTags, thresholds );
+		const unsigned int numTags = inputData.size( );
+		const unsigned int numWindows = thresholds.size( );
+
+		double disc = 0.0;
+		if( threadPool != NULL && threadPool->numThreads( ) > 1 && numWindows > 1
+			&& numTags >= static_cast< unsigned int >( HotspotDefaults::MIN_TAGS_PARALLEL_SWEEP ) )
+		{
+			// Sweep blocks of window sizes concurrently, then fold the hits into
+			// hotspots tag by tag, in increasing window size, as the serial loop does
+			std::vector< std::vector< WindowHit > > hits( numWindows );
+			std::vector< double > windowDisc( numWindows, 0.0 );
+			unsigned int numBlocks = std::min( numWindows, static_cast< unsigned int >( threadPool->numThreads( ) ) );
+			std::vector< WindowSweepTask > tasks( numBlocks );
+			ThreadPool::TaskGroup group;
+			for( unsigned int b = 0, first = 0; b < numBlocks; b++ )
+			{
+				unsigned int last = ( numWindows * ( b + 1 ) ) / numBlocks;
+				tasks[b].inputData = &inputData;
+				tasks[b].thresholds = &thresholds[first];
+				tasks[b].hits = &hits[first];
+				tasks[b].disc = &windowDisc[first];
+				tasks[b].numWindows = last - first;
+				threadPool->submit( &tasks[b], group );
+				first = last;
+			}
+			threadPool->wait( group );
+
+			std::vector< unsigned int > next( numWindows, 0 );
+			while( true )
+			{
+				unsigned int tag = numTags;
+				for( unsigned int w = 0; w < numWindows; w++ )
+				{
+					if( next[w] < hits[w].size( ) && hits[w][next[w]].tag < tag )
+					{
+						tag = hits[w][next[w]].tag;
+					}
+				}
+				if( tag == numTags )
+				{
+					break;
+				}
+				int row = -1;
+				for( unsigned int w = 0; w < numWindows; w++ )
+				{
+					if( next[w] < hits[w].size( ) && hits[w][next[w]].tag == tag )
+					{
+						row = AddWindowHit( hotspots, row, hits[w][next[w]++], thresholds[w].winsize );
+					}
+				}
+				hotspots.weightedAvgSD[row] /= hotspots.densCount[row];
+			}
+			for( unsigned int w = 0; w < numWindows; w++ )
+			{
+				disc = std::max( disc, windowDisc[w] );
+			}
+			return disc;
+		}
+
+		std::vector< WindowCursor > cursors( numWindows );
+		for( unsigned int i = 0; i < numTags; i++ )
+		{
+			ScanTag( inputData, i, thresholds, cursors, hotspots, disc );
+		}  // over all clones
+
+		return disc;
+	}
+
+	/**
+	 * Merges candidate hotspots, taken in tag order, into clusters.  A candidate
+	 * joins the open cluster while its center is within its window size of the
+	 * center of the cluster's first candidate; otherwise it closes that cluster
+	 * and opens another.  Each cluster is appended to the output table when it
+	 * is closed.
+	 */
+	class HotspotClusterer
+	{
+	public:
+		HotspotClusterer( HotspotTable& filteredHotspots )
+			: _filteredHotspots( filteredHotspots ), _open( false ),
+			  _filterIndexLeft( 0 ), _filterIndexRight( 0 ), _filterWidth( 0.0 ),
+			  _lastCenter( 0 ), _filterCluster( 0 ),
+			  _adjustedCenter( 0.0 ), _averageCount( 0.0 ), _averageSd( 0.0 )
+		{ }
+
+		/**
+		 * Add candidate <i> of <hotspots>
+		 */
+		void add( const HotspotTable& hotspots, int i )
+		{
+			int tagNum = hotspots.tagIndex[i];
+			int averagePos = hotspots.averagePos[i];
+			int maxWindow = hotspots.maxWindow[i];
+
+			if( _open && std::abs( _lastCenter - averagePos ) < maxWindow )
+			{
+				// same cluster
+				_filterIndexRight = tagNum; // shift over right boundary
+				_filterWidth += maxWindow;
+
+				// Adjust windowing and filtering helper vars
+				_adjustedCenter += static_cast< double >( averagePos );
+				_averageCount += hotspots.densCount[i];
+				_averageSd += hotspots.weightedAvgSD[i];
+				_filterCluster++;
+				return;
+			}
+
+			// new cluster
+			// Note that this clause takes into effect if a continuing cluster gets too big, OR if a new
+			// cluster has started with intervening denscount = 0 and the new cluster centroid is greater than maxwindow[i]
+			// from the old centroid.
+			if( _open )
+			{
+				finish( true );
+			}
+			_filterIndexLeft = tagNum;
+			_filterIndexRight = tagNum;
+			_filterWidth = maxWindow;
+			_lastCenter = averagePos;
+			_adjustedCenter = static_cast< double >( _lastCenter );
+			_averageCount = hotspots.densCount[i];
+			_averageSd = hotspots.weightedAvgSD[i];
+			_filterCluster = 1;  // reset to 1 item in cluster
+			_open = true;
+		}
+
+		/**
+		 * Finish the open cluster, if there is one
+		 */
+		void close( )
+		{
+			if( _open )
+			{
+				finish( false );
+			}
+		}
+
+		bool isOpen( ) const { return _open; }
+
+		// Tag number of the first candidate in the open cluster
+		int firstTag( ) const { return _filterIndexLeft; }
+
+		// Center of the first candidate in the open cluster
+		int lastCenter( ) const { return _lastCenter; }
+
+	private:
+		// Move the centroid to the average position of the assigned clones, and
+		// append the cluster
+		void finish( bool followed )
+		{
+			HotspotTable& h = _filteredHotspots;
+			int currCluster = h.appendCluster( );
+			h.filterIndexLeft[currCluster] = _filterIndexLeft;
+			h.filterIndexRight[currCluster] = _filterIndexRight;
+			h.averagePos[currCluster] = static_cast< int >( _adjustedCenter / _filterCluster );
+			h.filterWidth[currCluster] = _filterWidth / _filterCluster;
+			h.densCount[currCluster] = _averageCount / _filterCluster;
+			h.weightedAvgSD[currCluster] = _averageSd / _filterCluster;
+			if( followed && h.filterWidth[currCluster] > highInt*2 )
+			  {
+			    std::cerr << "else: filterwidth=" << h.filterWidth[currCluster] << ", filterCluster=" << _filterCluster << std::endl;;
+			  }
+			_open = false;
+		}
+
+		HotspotTable& _filteredHotspots;
+		bool _open;
+		int _filterIndexLeft, _filterIndexRight;
+		double _filterWidth;
+		int _lastCenter, _filterCluster;
+		double _adjustedCenter, _averageCount, _averageSd;
+	};
+
+	void FilterHotspots( const HotspotTable& hotspots, HotspotTable& filteredHotspots )
+	{
+		// Considering each known hotspot, create filteredHotspots
+		HotspotClusterer clusterer( filteredHotspots );
+		for( int i = 0; i < hotspots.size( ); ++i )
+		{
+			clusterer.add( hotspots, i );
+		}
+		// finish last cluster
+		clusterer.close( );
+	}
+
+  // Tag positions that ClusterSize carries from one cluster to the next: the
+  // extent of the last cluster that contained any tags
+  struct ClusterSpan
+  {
+    int leftPos, rightPos;
 
-	bool headerPrinted = false;
-	std::vector< int > inputData;
-	std::vector< int > mappableCounts;
+    ClusterSpan( ) : leftPos( 0 ), rightPos( 0 ) { }
+  };
+
+  // The window of countDensity2 for a cluster centered on <base>
+  inline void Density2Window( int base, int& leftdens, int& rightdens )
+  {
+    int subWindows = densityWin / densityWinSmall;
+    int start = (base / densityWinSmall) - (subWindows / 2);
+    leftdens = start * densityWinSmall;
+    rightdens = leftdens + densityWin - 1;
+  }
+
+  /**
+   * The lowest and highest tag positions that ScoreCluster looks at for row <i>,
+   * apart from the tags of its own candidates
+   */
+  void ClusterReach( const HotspotTable& h, int i, int densityWin, double& low, double& high )
+  {
+    int halfDensityWin = densityWin / 2;
+    int leftdens2, rightdens2;
+    Density2Window( h.averagePos[i], leftdens2, rightdens2 );
+    low = std::min( h.averagePos[i] - h.filterWidth[i] / 2,
+		    static_cast< double >( std::min( h.averagePos[i] - halfDensityWin, leftdens2 ) ) );
+    high = std::max( h.averagePos[i] + h.filterWidth[i] / 2,
+		     static_cast< double >( std::max( h.averagePos[i] + halfDensityWin, rightdens2 ) ) );
+  }
+
+  /**
+   * Size and score cluster <i> of <h>.  <inputData> holds the chromosome's tags
+   * from tag number <base> on, which must include every tag the cluster reaches.
+   */
+  void ScoreCluster( const std::vector<int>& inputData, int base, int densityWin, HotspotTable& h, int i,
+		     const std::vector< int >& mappableCounts, const MappableSums& mappableSums,
+		     ClusterSpan& span, std::ostream& log )
+  {
+    int contcount,leftdens,rightdens;
+    double leftcent, rightcent;
+    int halfDensityWin = densityWin / 2;
+    /* double probz,meanz,sdz; */
+
+    // Tags are sorted, so every tag count below is a pair of binary searches
+    std::vector< int >::const_iterator tagsBegin = inputData.begin( ), tagsEnd = inputData.end( );
+
+	leftcent  = h.averagePos[i] - h.filterWidth[i] / 2;
+	rightcent = h.averagePos[i] + h.filterWidth[i] / 2;
+	leftdens = h.averagePos[i] - halfDensityWin;
+	rightdens = h.averagePos[i] + halfDensityWin;
+
+	// tags in [leftcent, rightcent]
+	int centBegin = std::lower_bound( tagsBegin, tagsEnd, leftcent ) - tagsBegin;
+	int centEnd = std::upper_bound( tagsBegin, tagsEnd, rightcent ) - tagsBegin;
+	contcount = std::max( centEnd - centBegin, 0 );
+	if( contcount > 0 )
+	  {
+	    span.leftPos = inputData[centBegin];
+	    span.rightPos = inputData[centEnd - 1];
+	  }
 
-	// Main processing loop: each pass considers each chromosome in the input data set
-	while( inputDataReader.readNextChrom( inputData ) > 0 )
-    {
-		std::cerr << "Processing chrom: " << inputDataReader.currentChromName( ) << std::endl;
-
-		// get counts of 'background' mappable K-mers on each 50kb interval on that chromosome
-    	int numRead = mappableCountsDataReader.readChrom(inputDataReader.currentChromName( ), mappableCounts );
-    	if( numRead < 0 )
-    	{
-    		std::cerr << "Error reading background file. Aborting" << std::endl;
-			exit( EXIT_FAILURE );
-    	}
-
-    	// Compute the hot spots and filter them
-   		std::cerr << "Compute Hot Spots " << std::endl;
-       	std::map< int, Hotspot* > hotspots;
-  		hotspot::ComputeHotSpots( inputData, hotspot::lowInt, hotspot::highInt, hotspot::incInt, hotspots );
-   		std::cerr << "Filter Hot Spots " << std::endl;
-       	std::map< int, Hotspot* > filteredHotspots;
-   		hotspot::FilterHotspots( hotspots, filteredHotspots );
-
-   		// Calculate cluster size, and other hotspot statistics
-   		if( hotspot::useGenomeDensWin)
-   		{
-   			// These vars are updated (side-effect) of the ClusterSize routine
-   			hotspot::numGenomeDens = 0; hotspot::numLocalDens = 0;
-   			hotspot::genomeDensZ = 0.0; hotspot::localDensZ = 0.0;
-   		}
-   		std::cerr << "Cluster Size" << std::endl;
-   		hotspot::ClusterSize( inputData, hotspot::densityWin, filteredHotspots, mappableCounts );
-
-   		if( hotspot::useGenomeDensWin )
-   		{
-   			std::cerr << hotspot::numGenomeDens
-						<< " clusters scored using genome-wide density, avg. z = "
-						<< hotspot::genomeDensZ / hotspot::numGenomeDens
-						<< "; " << hotspot::numLocalDens
-						<< " scored using local density, avg. z = "
-						<< hotspot::localDensZ / hotspot::numLocalDens
-						<< std::endl;
-   		}
-
-   		// Summarize the results of this chromosome. Reset temp data structures
-   		std::map< int, Hotspot* >::iterator iter;
-   		for( iter = hotspots.begin( ); iter != hotspots.end( ); ++iter )
-   		{
-   			delete iter->second;
-   		}
-   		if(! headerPrinted )
-   		{
-   			Hotspot::printHeader( hotspot::fpout );
-   			headerPrinted = true;
-   		}
-   		for( iter = filteredHotspots.begin(); iter != filteredHotspots.end(); ++iter )
-   		{
-   			//TODO remove costly char lookup to one-time lookup outside loop
-   			iter->second->printOut( inputDataReader.currentChromName().c_str( ), hotspot::fpout );
-   			delete iter->second;
-   		}
-
-   		std::cerr << "Chrom summary: " << filteredHotspots.size( ) << std::endl;
-   		std::fflush( hotspot::fpout );
-   		mappableCounts.clear( );
-   		inputData.clear( );
-
-    }  // end loop over all chromosomes
+	// tags in [leftdens, rightdens]
+	int densBegin = std::lower_bound( tagsBegin, tagsEnd, leftdens ) - tagsBegin;
+	int densEnd = std::upper_bound( tagsBegin, tagsEnd, rightdens ) - tagsBegin;
+	if( densEnd > densBegin )
+	  {
+	    h.filterDensIndexLeft[i] = base + densBegin;
+	  }
 
-	// Release open resources
-    if( hotspot::fpout )
-    {
-    	std::fclose( hotspot::fpout );
+	// last tag up to the farther of the two right edges
+	h.filterDensIndexRight[i] = base + std::max( centEnd, densEnd ) - 1;
+	h.filterSize[i] = contcount;
+	h.filterDist[i] = span.rightPos - span.leftPos + 1; // changed to add 1 -- RET
+	h.minSite[i] = inputData[h.filterIndexLeft[i] - base];
+	h.maxSite[i] = inputData[h.filterIndexRight[i] - base];
+
+	int uniquelyMappableSitesInWindow = countMappableSites( h.averagePos[i], densityWin, densityWinSmall,
+								mappableCounts, mappableSums, log );
+	int fewEnoughSites = 2; //densityWinSmall; //densityWindowSize / 2;
+	// Now using exact counts from the interval, so we shouldn't need this anymore:
+	if (uniquelyMappableSitesInWindow < fewEnoughSites)
+	{
+		// let's put a limit on the adjustment
+		log << "Warning: only " << uniquelyMappableSitesInWindow
+					<< " of " << densityWin
+					<< " are mappable, increasing to "
+					<< fewEnoughSites << "..." << std::endl;
+		uniquelyMappableSitesInWindow = fewEnoughSites;
 	}
 
-    std::exit( EXIT_SUCCESS );
-}
+	// Following counts tags in the nearest 50kb window starting on a 10kb boundary, to
+	// match the windows used in countMappableSites.  The z-score is left to
+	// ScoreClusters, a batch of clusters at a time.
+	h.spannedBases[i] = lround( h.filterWidth[i] );
+	h.densTags[i] = countDensity2( h.averagePos[i], inputData );
+	h.mappableSites[i] = uniquelyMappableSitesInWindow;
+  }
 
-namespace hotspot
-{
+  void ClusterSize( const std::vector<int>& inputData, int densityWin, HotspotTable& filteredHotspots,
+		    const std::vector< int >& mappableCounts, int backgroundTags, DensityWindowStats& densStats,
+		    std::ostream& log )
+  {
+    // finally go through and determine the number of library clones contained
+    // in filterwidth, also get the maximum inter-cluster width
+    MappableSums mappableSums;
+    BuildMappableSums( mappableCounts, densityWinSmall, mappableSums );
 
-	double ComputeHotSpots( const std::vector< int>& inputData, int winLow,	int winHigh,
-							int winInc, std::map< int, Hotspot* >& hotspots )
+    ClusterSpan span;
+    for( int i = 0; i < filteredHotspots.size( ); ++i )
+      {
+	ScoreCluster( inputData, 0, densityWin, filteredHotspots, i, mappableCounts, mappableSums, span, log );
+      }
+    ScoreClusters( filteredHotspots, 0, filteredHotspots.size( ), backgroundTags, densStats );
+    return;
+  }
+
+	int ProcessChromsStreaming( InputDataReader& inputDataReader, MappableCountsDataReader& mappableCountsDataReader )
 	{
-		/* computes an estimate of the discrepancy using the class
-		   of 1-dimensional intervals of width winLow to winHigh  */
+		std::vector< WindowThreshold > thresholds;
+		ComputeWindowThresholds( lowInt, highInt, incInt, totaltagcount, thresholds );
+		const unsigned int numWindows = thresholds.size( );
+		long long maxHalfWidth = 0;
+		long long maxWindow = 0;
+		for( unsigned int w = 0; w < numWindows; w++ )
+		{
+			maxHalfWidth = std::max( maxHalfWidth, static_cast< long long >( thresholds[w].halfWidth ) );
+			maxWindow = std::max( maxWindow, static_cast< long long >( thresholds[w].winsize ) );
+		}
+		// How far left of its center a cluster's statistics can reach
+		long long reachLeft = maxWindow / 2 + densityWin / 2 + 2LL * densityWinSmall;
+
+		bool headerPrinted = false;
+		int numTagsRead = 0;
+		std::vector< int > tags; // the tags of the current chromosome still in use
+		std::vector< int > mappableCounts;
+		MappableSums mappableSums;
+		HotspotArena arena;
+		HotspotTable& candidates = arena.candidates;
+		HotspotTable& clusters = arena.clusters;
+		HotspotBed* bed = LibraryBed( 0 );
+		ChromStats stats;
+		int numChroms = 0;
+		StageClock clock( ( runStats != NULL ) ? &stats : NULL );
+
+		while( true )
+		{
+			clock.start( );
+			tags.clear( );
+			bool chromEnded = false;
+			int numRead = inputDataReader.readChromTags( tags, HotspotDefaults::STREAM_CHUNK_TAGS, chromEnded );
+			if( numRead < 0 )
+			{
+				exit( EXIT_FAILURE ); // malformed input, already reported
+			}
+			if( numRead == 0 )
+			{
+				break; // every chromosome starts with a tag
+			}
 
-		genomeSize = mpblGenomeSize; // RET:  changed from EDH's value of 3.0E9
+			const std::string chromName = inputDataReader.currentChromName( );
+			std::cerr << "Processing chrom: " << chromName << std::endl;
+			mappableCounts.clear( );
+			if( mappableCountsDataReader.readChrom( chromName, mappableCounts ) < 0 )
+			{
+				std::cerr << "Error reading background file. Aborting" << std::endl;
+				exit( EXIT_FAILURE );
+			}
+			if(! headerPrinted )
+			{
+				Hotspot::printHeader( fpout, printPValues, printPValues && useGenomeDensWin );
+				headerPrinted = true;
+			}
+			BuildMappableSums( mappableCounts, densityWinSmall, mappableSums );
+			clock.lap( STAGE_READ );
+
+			arena.clear( );
+			HotspotClusterer clusterer( clusters );
+			std::vector< WindowCursor > cursors( numWindows );
+			DensityWindowStats densStats;
+			ClusterSpan span;
+			double disc = 0.0;
+			int base = 0;          // tag number of tags[0]
+			unsigned int next = 0; // the next tag to scan, in tags
+			int scored = 0;        // clusters already scored and written
+			int numClusters = 0;
+			while( true )
+			{
+				numTagsRead += numRead;
 
-		double disc = 0.0;
-		int wincount = 0;
-		for (int winsize = winLow; winsize <= winHigh; winsize += winInc, wincount++ )
-		{
-			unsigned int startmarker=0; // market to the first point that can be in window
-			double prob = winsize / genomeSize;
-			double mean = prob * totaltagcount;  // RET: adjust for sampling fraction
-
-			double sd = std::sqrt(prob*(1-prob)*totaltagcount);  // RET: adjust for sampling fraction
-			double detectThresh = 1 + mean + numSD * sd;  // includes offset of 1 as we are centering on clones
-
-			//    cout << "Comparative Probs " << endl;
-			//    cout << "Window size " << winsize << endl;
-			//    cout << "Mean " << mean <<  endl;
-			//    cout << "sd " << sd <<  endl;
-			//    cout << "detect " << detectThresh  << endl << endl;
-
-			for( unsigned int i = 0; i < inputData.size( ); i++ )
-			{
-				int contained = 0;
-				double clonePosAvg = 0.0;
-
-				// center interval on lib point, assume sorted library points
-				double leftEnd  = inputData[i] - winsize/2.0;
-				double rightEnd = inputData[i] + winsize/2.0;
-				// std::printf("leftEnd %f rightEnd %f\n",leftEnd,rightEnd);
-				if ((leftEnd > inputData[startmarker]) && (startmarker<inputData.size( ))) { startmarker++; }
-				unsigned int walkmarker = startmarker;
-
-				while ((inputData[walkmarker] <= rightEnd)&&(walkmarker<inputData.size( ))) {
-					if ((inputData[walkmarker] >= leftEnd) && (inputData[walkmarker] <= rightEnd)) {
-						contained++;
-						clonePosAvg += inputData[walkmarker];
+				// Scan each tag whose widest window is complete
+				while( next < tags.size( )
+					   && ( chromEnded || tags.back( ) > tags[next] + maxHalfWidth ) )
+				{
+					int row = ScanTag( tags, next, thresholds, cursors, candidates, disc );
+					if( row >= 0 )
+					{
+						candidates.tagIndex[row] += base;
+						clusterer.add( candidates, row );
+						candidates.clear( );
+						stats.candidates++;
 					}
-					walkmarker++;
+					next++;
 				}
-				if (contained > 0)
+
+				// Every later candidate is centered at least maxHalfWidth left of its
+				// tag, and can only join a cluster within maxWindow of its center
+				if( clusterer.isOpen( )
+					&& ( chromEnded || ( next < tags.size( )
+										 && tags[next] - maxHalfWidth - clusterer.lastCenter( ) >= maxWindow ) ) )
 				{
-					clonePosAvg = clonePosAvg / contained;
-					if ( useFuzzyThreshold )
-					  {
-					    double detectThresh = 1 + mean + numSD * sd;  // includes offset of 1 as we are centering on clones
-					    if (std::fabs(contained - detectThresh) <= 0.5)
-					      {
-						double randVal = std::rand( ) /  static_cast< double >( RAND_MAX );
-						detectThresh += ( randVal - 0.5 );
-					      }
-					  }
+					clusterer.close( );
 				}
+				clock.lap( STAGE_SWEEP );
 
-				double contFrac = contained /(double)totaltagcount; // RET: adjust for sampling fraction
-				double diff = std::fabs(contFrac-prob);
-
-				if (contained > detectThresh)
+				// Score and write each cluster that no later tag can change
+				int numWritten = 0;
+				while( scored < clusters.size( ) )
 				{
-					// determine number of sd's corresponding to this intensity.
-					// algorithm finds largest window over range containing anomaly.
-					double currSD = (contained - 1 - mean) / sd;
-
-					// Make a new hotspot for this index
-					if( hotspots.count( i ) == 0 )
+					double low, high;
+					ClusterReach( clusters, scored, densityWin, low, high );
+					if( ! chromEnded && ! ( tags.back( ) > high ) )
 					{
-						Hotspot* h = new Hotspot;
-						hotspots[ i ] = h;
+						break;
 					}
-					hotspots[i]->densCount += 1;
-					hotspots[i]->weightedAvgSD += currSD;
-					hotspots[i]->averagePos = static_cast< int >(clonePosAvg + 0.5);
-					hotspots[i]->maxWindow = winsize;
+					ScoreCluster( tags, base, densityWin, clusters, scored, mappableCounts, mappableSums, span, std::cerr );
+					scored++;
+					numWritten++;
+				}
+				ScoreClusters( clusters, scored - numWritten, scored, backgroundTotalTagCount, densStats );
+				clock.lap( STAGE_CLUSTER );
+				for( int i = scored - numWritten; i < scored; i++ )
+				{
+					Hotspot::printOut( clusters, i, chromName, arena.output, printPValues, printPValues && useGenomeDensWin );
+				}
+				arena.output.writeTo( fpout );
+				if( bed != NULL )
+				{
+					bed->add( numChroms, chromName, clusters, scored - numWritten, scored );
+				}
+				numClusters += numWritten;
+				clock.lap( STAGE_WRITE );
+				if( chromEnded )
+				{
+					break;
+				}
+				if( numWritten > 0 )
+				{
+					std::fflush( fpout );
+				}
+				if( scored > 0 && scored >= clusters.size( ) / 2 )
+				{
+					clusters.eraseFront( scored );
+					scored = 0;
 				}
-				if (diff > disc) {disc=diff;}
-			}  // over all clones
-		}  // over all window sizes
-
-		std::map< int, Hotspot* >::iterator iter;
-		for( iter = hotspots.begin( ); iter != hotspots.end( ); ++iter )
-		{
-			iter->second->weightedAvgSD /= iter->second->densCount;
-		}
-
-		std::cerr << "Completing HotSpot Identification" << std::endl;
-		return disc;
-	}
 
-	void FilterHotspots( const std::map<int, Hotspot* >& hotspots,
-				std::map< int, Hotspot* >& filteredHotspots )
-	{
-		// Iteration/windowing helper vars
-	        // TODO: filterCluster and lastCenter might not be properly initialized
-		int filterCluster = 0, lastCenter = 0;
-		double averageCount = 0.0;
-		double averageSd = 0.0;
-		double adjustedCenter = 0.0;
-		int numFilteredHotspots = 0;
-		bool firstPassInit = true;
+				// Drop the tags that nothing pending can reach
+				unsigned int keep = next;
+				for( unsigned int w = 0; w < numWindows; w++ )
+				{
+					keep = std::min( keep, cursors[w].left );
+				}
+				// Clusters yet to be closed are centered no further left than maxHalfWidth
+				// before their first tag
+				long long firstPos = ( next < tags.size( ) ) ? tags[next] : tags.back( );
+				if( clusterer.isOpen( ) )
+				{
+					keep = std::min( keep, static_cast< unsigned int >( clusterer.firstTag( ) - base ) );
+					firstPos = std::min( firstPos, static_cast< long long >( tags[ clusterer.firstTag( ) - base ] ) );
+				}
+				keep = std::min( keep, static_cast< unsigned int >(
+					std::lower_bound( tags.begin( ), tags.end( ), firstPos - maxHalfWidth - reachLeft ) - tags.begin( ) ) );
+				for( int i = scored; i < clusters.size( ); i++ )
+				{
+					double low, high;
+					ClusterReach( clusters, i, densityWin, low, high );
+					unsigned int reach = std::lower_bound( tags.begin( ), tags.end( ), low ) - tags.begin( );
+					keep = std::min( keep, std::min( reach, static_cast< unsigned int >( clusters.filterIndexLeft[i] - base ) ) );
+				}
+				if( keep > 0 && keep >= tags.size( ) / 2 )
+				{
+					tags.erase( tags.begin( ), tags.begin( ) + keep );
+					base += keep;
+					next -= keep;
+					for( unsigned int w = 0; w < numWindows; w++ )
+					{
+						cursors[w].left -= keep;
+						cursors[w].right -= keep;
+					}
+				}
 
-		// Considering each known hotspot, create filteredHotspots
-		std::map<int, Hotspot*>::const_iterator iter;
-		for( iter = hotspots.begin( ); iter != hotspots.end( ); ++iter )
-		{
-			Hotspot* currHotspot = iter->second;
-			int tagNum = iter->first;
-
-			// Init first cluster
-			if( firstPassInit )
-			{
-				Hotspot* h = new Hotspot;
-				h->densCount = currHotspot->densCount;
-				h->averagePos = currHotspot->averagePos;
-				h->weightedAvgSD = currHotspot->weightedAvgSD;
-				h->filterIndexLeft = tagNum;
-				h->filterIndexRight = tagNum;
-				h->filterWidth = currHotspot->maxWindow;
-				filteredHotspots[ numFilteredHotspots ] = h;
-
-				lastCenter = currHotspot->averagePos;
-				adjustedCenter = static_cast< double >( lastCenter );
-				averageCount = currHotspot->densCount;
-				averageSd = currHotspot->weightedAvgSD;
-				filterCluster = 1;
-				firstPassInit = false;
-				continue;
+				numRead = inputDataReader.readChromTags( tags, HotspotDefaults::STREAM_CHUNK_TAGS, chromEnded );
+				if( numRead < 0 )
+				{
+					exit( EXIT_FAILURE ); // malformed input, already reported
+				}
+				clock.lap( STAGE_READ );
 			}
 
-			if( std::abs( lastCenter - currHotspot->averagePos ) < currHotspot->maxWindow )
+			// Report the stages in the order a whole-chromosome run does
+			std::cerr << "Compute Hot Spots " << std::endl;
+			std::cerr << "Completing HotSpot Identification" << std::endl;
+			std::cerr << "Filter Hot Spots " << std::endl;
+			std::cerr << "Cluster Size" << std::endl;
+			if( useGenomeDensWin )
 			{
-				// same cluster
-				filteredHotspots[ numFilteredHotspots ]->filterIndexRight = tagNum; // shift over right boundary
-				filteredHotspots[ numFilteredHotspots ]->filterWidth += currHotspot->maxWindow;
-
-				// Adjust windowing and filtering helper vars
-				adjustedCenter += static_cast< double >( currHotspot->averagePos );
-				averageCount += currHotspot->densCount;
-				averageSd += currHotspot->weightedAvgSD;
-				filterCluster++;
-			}
-			else // new cluster
-			{
-				// Note that this clause takes into effect if a continuing cluster gets too big, OR if a new
-				// cluster has started with intervening denscount = 0 and the new cluster centroid is greater than maxwindow[i]
-				// from the old centroid.
-				// Before starting a new cluster move the centroid to the average position of
-				// assigned clones.
-				filteredHotspots[ numFilteredHotspots ]->averagePos = static_cast< int >( adjustedCenter / filterCluster );
-				filteredHotspots[ numFilteredHotspots ]->filterWidth /= filterCluster;
-				filteredHotspots[ numFilteredHotspots ]->densCount = averageCount / filterCluster;
-				filteredHotspots[ numFilteredHotspots ]->weightedAvgSD = averageSd / filterCluster;
-				if(filteredHotspots[ numFilteredHotspots ]->filterWidth > highInt*2)
-				  {
-				    std::cerr << "else: filterwidth=" << filteredHotspots[ numFilteredHotspots ]->filterWidth << ", filterCluster=" << filterCluster << std::endl;;
-				  }
-
-				// then increment and initialize a new cluster
-				numFilteredHotspots++;
-
-				Hotspot* h = new Hotspot;
-				filteredHotspots[ numFilteredHotspots ] = h;
-				h->filterIndexLeft = tagNum;
-				h->filterIndexRight = tagNum;
-				h->filterWidth = currHotspot->maxWindow;
-				lastCenter =  currHotspot->averagePos;
-				adjustedCenter = static_cast< double >( lastCenter );
-				averageCount = currHotspot->densCount;
-				averageSd = currHotspot->weightedAvgSD;
-				filterCluster = 1;  // reset to 1 item in cluster
+				std::cerr << densStats.numGenomeDens
+					<< " clusters scored using genome-wide density, avg. z = "
+					<< densStats.genomeDensZ / densStats.numGenomeDens
+					<< "; " << densStats.numLocalDens
+					<< " scored using local density, avg. z = "
+					<< densStats.localDensZ / densStats.numLocalDens
+					<< std::endl;
+			}
+			std::cerr << "Chrom summary: " << numClusters << std::endl;
+			std::fflush( fpout );
+			clock.lap( STAGE_WRITE );
+			if( runStats != NULL )
+			{
+				stats.order = numChroms;
+				stats.chrom = chromName;
+				stats.tags = base + tags.size( );
+				stats.hotspots = numClusters;
+				runStats->addChrom( stats );
+				stats = ChromStats( );
 			}
+			numChroms++;
 		}
-		// finish last cluster
-		if( filterCluster > 0 ) // need this test in case there were no hotspots
-		  {
-		    filteredHotspots[ numFilteredHotspots ]->averagePos = static_cast< int >( adjustedCenter / filterCluster );
-		    filteredHotspots[ numFilteredHotspots ]->densCount = averageCount / filterCluster;
-		    filteredHotspots[ numFilteredHotspots ]->weightedAvgSD = averageSd / filterCluster;
-		    filteredHotspots[ numFilteredHotspots ]->filterWidth /= filterCluster;
-		  }
+		if( runStats != NULL )
+		{
+			runStats->noteArenaBytes( arena.bytes( ) );
+		}
+		return numTagsRead;
 	}
 
-  void ClusterSize( const std::vector<int>& inputData, int densityWin, std::map< int, Hotspot* >& filteredHotspots,
-		    const std::vector< int >& mappableCounts )
-  {
-    // finally go through and determine the number of library clones contained
-    // in filterwidth, also get the maximum inter-cluster width
-
-    // TODO: leftindex might not be properly initialized
-    int contcount,leftindex = -1, rightindex = -1,leftdens,rightdens,dencount;
-    double leftcent, rightcent;
-    int halfDensityWin = densityWin / 2;
-    /* double probz,meanz,sdz; */
-
-    std::map<int, Hotspot* >::iterator iter;
-    for( iter = filteredHotspots.begin( ); iter != filteredHotspots.end( ); ++iter)
-      {
-	Hotspot *currHotspot = iter->second;
-
-	leftcent  = currHotspot->averagePos - currHotspot->filterWidth / 2;
-	rightcent = currHotspot->averagePos + currHotspot->filterWidth / 2;
-	leftdens = currHotspot->averagePos - halfDensityWin;
-	rightdens = currHotspot->averagePos + halfDensityWin;
-
-	contcount=0;
-	dencount=0;
-	unsigned int libIdx;
-	for (libIdx = 0; libIdx < inputData.size(); libIdx++)
-	  {   // for every tag on that chrome
-	    if ((inputData[libIdx] >= leftcent) && (inputData[libIdx] <= rightcent))
-	      {
-		if (contcount==0) 
-		  {
-		    leftindex=libIdx;
-		  }
-		rightindex=libIdx;
-		contcount++;
-	      }
-	    if ((inputData[libIdx] >= leftdens) && (inputData[libIdx] <= rightdens))
-	      {
-		if(dencount == 0)
-		  {
-		    currHotspot->filterDensIndexLeft = libIdx;
-		  }
-		dencount++;
-	      }
-	    if (inputData[libIdx] > rightdens && inputData[libIdx] > rightcent) 
-	      {
-		break;
-	      }
-	  }
-	currHotspot->filterDensIndexRight = libIdx - 1;
-	currHotspot->filterSize = contcount;
-	currHotspot->filterDist = inputData[rightindex] - inputData[leftindex] + 1; // changed to add 1 -- RET
-	currHotspot->minSite = inputData[currHotspot->filterIndexLeft];
-	currHotspot->maxSite = inputData[currHotspot->filterIndexRight];
-
-	int uniquelyMappableSitesInWindow = countMappableSites( currHotspot->averagePos, densityWin, densityWinSmall,
-								mappableCounts );
-
-
-	// Following counts tags in the nearest 50kb window starting on a 10kb boundary, to
-	// match the windows used in countMappableSites.
-	int dencount2 = countDensity2( currHotspot->averagePos, inputData );
-	currHotspot->filteredZScoreAdjusted = calculateZScore( lround( currHotspot->filterWidth), currHotspot->filterSize,
-							       densityWin, dencount2, uniquelyMappableSitesInWindow );
-      }
-    return;
-  }
+	void BuildMappableSums( const std::vector< int >& mappableCounts, int densityWinSmall,
+							MappableSums& sums )
+	{
+		sums.sites.assign( 1, 0 );
+		sums.overfull.assign( 1, 0 );
+		sums.sites.reserve( mappableCounts.size( ) + 1 );
+		sums.overfull.reserve( mappableCounts.size( ) + 1 );
+		for( unsigned int i = 0; i < mappableCounts.size( ); ++i )
+		{
+			bool over = mappableCounts[i] > densityWinSmall;
+			sums.sites.push_back( sums.sites.back( ) + ( over ? densityWinSmall : mappableCounts[i] ) );
+			sums.overfull.push_back( sums.overfull.back( ) + ( over ? 1 : 0 ) );
+		}
+	}
 
 	int countMappableSites( int base, int densityWin, int densityWinSmall,
-							const std::vector< int>& mappableCounts )
+							const std::vector< int>& mappableCounts, const MappableSums& sums, std::ostream& log )
 	{
 		int sum = 0;
 		int subWindows = densityWin / densityWinSmall;
 		int start = ( base / densityWinSmall ) - ( subWindows / 2 );
 		if ( start < 0 ) start = 0;
-		for( int i = 0; i < subWindows; ++i)
-		{
-			int winCount = 0;
 
-			//TODO fix storage size discrepancy
-			if( (start + i ) >= static_cast< int >( mappableCounts.size( ) ) )
-			{
-				winCount = densityWinSmall;
-			}
-			else
+		// Bins past the end of mappableCounts count as fully mappable
+		int numBins = mappableCounts.size( );
+		int first = std::min( start, numBins );
+		int last = std::min( start + subWindows, numBins );
+		if( sums.overfull[last] == sums.overfull[first] )
+		{
+			sum = sums.sites[last] - sums.sites[first] + ( subWindows - ( last - first ) ) * densityWinSmall;
+		}
+		else
+		{
+			// Some bin exceeds its size; add the window up bin by bin so each one is reported
+			for( int i = 0; i < subWindows; ++i)
 			{
-				winCount = mappableCounts[start + i];
-			}
+				int winCount = 0;
 
-			if ( winCount > densityWinSmall )
-			{
-				std::cerr <<  "Warning: " << winCount << " > " << densityWinSmall << std::endl;
-				winCount = densityWinSmall;
+				//TODO fix storage size discrepancy
+				if( (start + i ) >= numBins )
+				{
+					winCount = densityWinSmall;
+				}
+				else
+				{
+					winCount = mappableCounts[start + i];
+				}
+
+				if ( winCount > densityWinSmall )
+				{
+					log <<  "Warning: " << winCount << " > " << densityWinSmall << std::endl;
+					winCount = densityWinSmall;
+				}
+				sum += winCount;
 			}
-			sum += winCount;
 		}
 
 		if( sum > densityWin )
 		{
-			std::cerr << "Error: " << sum << " > " << densityWin << std::endl;
+			log << "Error: " << sum << " > " << densityWin << std::endl;
 			sum = densityWin;
 		}
 		return sum;
@@ -453,21 +1634,14 @@ namespace hotspot
 
 	// Called on each Hotspot,during ClusterSize() operation.
 	// Counting the number of tags in the window marked by [leftdens <====> rightdens]
-	// Optimize by starting at current obs, look left until out-of-bounds, look right until out-of-bounds
+	// by binary search on the sorted tags
 
 	int countDensity2( int base, const std::vector< int >& inputData ) {
-		int subWindows = densityWin / densityWinSmall;
-		int start = (base / densityWinSmall) - (subWindows / 2);
-		int leftdens = start * densityWinSmall;
-		int rightdens = leftdens + densityWin - 1;
-		int dencount = 0;
-		for (unsigned int j = 0; j < inputData.size( ); j++) {   // for every tag on that chrome
-			if ((inputData[ j ] >= leftdens) && (inputData[ j ] <= rightdens)) {
-				dencount++;
-			}
-			if (inputData[ j ] > rightdens) {break;}
-		}
-		return dencount;
+		int leftdens, rightdens;
+		Density2Window( base, leftdens, rightdens );
+		std::vector< int >::const_iterator first = std::lower_bound( inputData.begin( ), inputData.end( ), leftdens );
+		std::vector< int >::const_iterator last = std::upper_bound( inputData.begin( ), inputData.end( ), rightdens );
+		return std::max( static_cast< int >( last - first ), 0 );
 	}
 
 	/* To adjust for local mappable K-mer density, just reduce the densityWindowSize
@@ -476,83 +1650,74 @@ namespace hotspot
 	   I use adjustedNumSitesInCluster as an estimate of how many sites I would observe
 	   in the density window if all the sites were actually mappable.
 	*/
-	double calculateZScore( int basesSpannedByCluster, int numSitesInCluster,
-			int densityWindowSize, int numSitesInDensityWindow, int numMappableSites )
+	void ScoreClusters( HotspotTable& h, int first, int last, int backgroundTags, DensityWindowStats& densStats )
 	{
-
-		int fewEnoughSites = 2; //densityWinSmall; //densityWindowSize / 2;
-		// Now using exact counts from the interval, so we shouldn't need this anymore:
-		if (numMappableSites < fewEnoughSites)
+		int n = last - first;
+		if( n <= 0 )
 		{
-			// let's put a limit on the adjustment
-			std::cerr << "Warning: only " << numMappableSites
-						<< " of " << densityWindowSize
-						<< " are mappable, increasing to "
-						<< fewEnoughSites << "..." << std::endl;
-			numMappableSites = fewEnoughSites;
+			return;
 		}
 
-		// Adjust probZ using mappable sites.
-		double probZ = ((double)basesSpannedByCluster) / (double)numMappableSites;
-		double meanZ = numSitesInDensityWindow * probZ;
-		double sdZ = std::sqrt(numSitesInDensityWindow * probZ * (1-probZ));
-		double zScore = (numSitesInCluster - meanZ) / sdZ;
-		// p-value = P(X >= k), where k = number tags in the cluster
-		// = 1 - P(X < k) = 1 - P(X <= k - 1).  For the binomial distribution, the cdf is given by
-		// the normalized (or regularized) incomplete beta function, I_x(a,b) (see wikipedia), and
-		// P(X <= k-1) = I_(1-p)(n - (k-1), k), where p = probability, n = number of tags in the
-		// density window.
+		// Straight loops over the scoring columns, which the compiler can
+		// vectorize, with each z-score the same sequence of operations it
+		// would be one hotspot at a time
+		const int* spanned = &h.spannedBases[ first ];
+		const int* inCluster = &h.filterSize[ first ];
+		const int* inWindow = &h.densTags[ first ];
+		const int* mappable = &h.mappableSites[ first ];
+		double* zScore = &h.filteredZScoreAdjusted[ first ];
+		for( int i = 0; i < n; i++ )
+		{
+			// Adjust probZ using mappable sites.
+			double probZ = ((double)spanned[i]) / (double)mappable[i];
+			double meanZ = inWindow[i] * probZ;
+			double sdZ = std::sqrt(inWindow[i] * probZ * (1-probZ));
+			zScore[i] = (inCluster[i] - meanZ) / sdZ;
+		}
 
 		// Number mappable bases genome-wide, from ~rthurman/proj/dhs-peaks/results/fdr/fdr.R
-		if ( !useGenomeDensWin )
-		  return zScore;
-		else
+		if( useGenomeDensWin )
 		{
-			double probZgw = ((double)basesSpannedByCluster) / mpblGenomeSize;
-			double meanZgw = backgroundTotalTagCount * probZgw;
-			double sdZgw = std::sqrt(backgroundTotalTagCount * probZgw * (1-probZgw));
-			double zScoregw = (numSitesInCluster - meanZgw) / sdZgw;
-			//std::printf("zScoregw = %f, zScore = %f\n", zScoregw, zScore);
-			gsl_sf_result beta_result;
-			double pVal, pValgw;
-			pVal = 0;
-			pValgw = 0;
-			int status = gsl_sf_beta_inc_e(numSitesInCluster, numSitesInDensityWindow - numSitesInCluster + 1, probZ, &beta_result);
-			if(status == 15){
-				//std::printf("Warning: underflow in pval computation, setting pVal = 0.\n");
-				pVal = 0.0;
-			}
-			else if(status){
-				//std::printf("gsl_sf_beta_inc_e error: status = %d, error = %s, setting pVal = 1.\n", status, gsl_strerror(status));
-				pVal = 1.0;
-			}
-			else
+			std::vector< double > zScoreGW( n );
+			for( int i = 0; i < n; i++ )
 			{
-				pVal = beta_result.val;
-			}
-			status = gsl_sf_beta_inc_e(numSitesInCluster, backgroundTotalTagCount - numSitesInCluster + 1, probZgw, &beta_result);
-			if(status == 15){
-				//std::printf("Warning: underflow in pval computation, setting pValgw = 0.\n");
-				pValgw = 0.0;
+				double probZgw = ((double)spanned[i]) / mpblGenomeSize;
+				double meanZgw = backgroundTags * probZgw;
+				double sdZgw = std::sqrt(backgroundTags * probZgw * (1-probZgw));
+				zScoreGW[i] = (inCluster[i] - meanZgw) / sdZgw;
 			}
-			else if(status){
-				//std::printf("gsl_sf_beta_inc_e error: status = %d, error = %s, setting pValgw = 1.\n", status, gsl_strerror(status));
-				pValgw = 1.0;
+			for( int i = 0; i < n; i++ )
+			{
+				if (zScoreGW[i] < zScore[i]){
+					densStats.genomeDensZ += zScoreGW[i];
+					densStats.numGenomeDens++;
+					zScore[i] = zScoreGW[i];
+				}else{
+					densStats.numLocalDens++;
+					densStats.localDensZ += zScore[i];
+				}
 			}
-			else
+		}
+
+		// p-value = P(X >= k), where k = number tags in the cluster, and X is
+		// binomial over the tags in the density window; under -gendw, also over
+		// all the background tags, each kept in its own column
+		if( printPValues )
+		{
+			double* pValue = &h.pValue[ first ];
+			for( int i = 0; i < n; i++ )
 			{
-				pValgw = beta_result.val;
+				double probZ = ((double)spanned[i]) / (double)mappable[i];
+				pValue[i] = BinomialUpperTailFast( inCluster[i], inWindow[i], probZ );
 			}
-			//std::printf("zScoregw = %f, zScore = %f, pVal = %g, pValgw = %g\n", zScoregw, zScore, pVal, pValgw);
-			if (zScoregw < zScore){
-				//std::printf("Genome-wide density used.\n");
-				genomeDensZ += zScoregw;
-				numGenomeDens++;
-				return zScoregw;
-			}else{
-				numLocalDens++;
-				localDensZ += zScore;
-				return zScore;
+		}
+		if( printPValues && useGenomeDensWin )
+		{
+			double* pValueGenome = &h.pValueGenome[ first ];
+			for( int i = 0; i < n; i++ )
+			{
+				double probZgw = ((double)spanned[i]) / mpblGenomeSize;
+				pValueGenome[i] = BinomialUpperTailFast( inCluster[i], backgroundTags, probZgw );
 			}
 		}
 	}
@@ -569,14 +1734,34 @@ namespace hotspot
 			msg += "\n    -range <int> <int> <int> (lower upper increment windows)";
 			msg += "\n    -densWin <int> (background window)";
 			msg += "\n    -minsd <float> (minimum for anomaly)";
-			msg += "\n    -fuzzy (flag to randomly adjust the hotspot selection threshold by 0-0.5)";
-			msg += "\n    -fuzzy-seed <int> (for use with fuzzy, seed the random number gen. Default = 1 )";
-			msg += "\n    -i <file-name> (input library file, must be in lexicographical sorted order)";
+			msg += "\n    -fuzzy, -fuzzy-seed <int> (accepted for compatibility; the threshold is never adjusted)";
+			msg += "\n    -i <file-name> (input library file, must be in lexicographical sorted order; - for standard input)";
+			msg += "\n        (-i and -o may be repeated in pairs, to process several libraries against one background at once)";
 			msg += "\n    -k <file-name> (input K-mer density file, must be in lexicographical sorted order)";
 			msg += "\n    -o <file-name> (output file for results)";
+			msg += "\n    -bed <file-name> (also write the hotspots at least -pass2-minsize wide with z-score above -pass2-z, and neither";
+			msg += "\n        nan nor inf, as sorted bed, as run_pass1_merge_and_thresh_hotspots extracts them; one for each -o file)";
+			msg += "\n    -wig <file-name> <track-name> (as -bed, headed by a track line)";
 			msg += "\n    -gendw (flag to use genome-wide density window if it gives lower z-score)";
+			msg += "\n    -pvals (flag to add a column of local binomial p-values, and with -gendw a column of genome-wide ones)";
 			msg += "\n    -bckgnmsize <float> (for computing background - default=2.55E9)";
 			msg += "\n    -bckntags <float> (for computing background - default=number of tags in library)";
+			msg += "\n    -threads <int> (number of threads for processing chromosomes and window sizes - default=1)";
+			msg += "\n    -stats <file-name> (write a JSON report of the time, counts and memory of each stage of each chromosome)";
+			msg += "\n    -tagcount <int> (number of tags in the library - required if it is not a regular file, which is then streamed on one thread)";
+			msg += "\n    -twopass <file-name> (also run pass 2, around the pass-1 hotspots, and write its results here; -bckntags then applies to pass 2 only)";
+			msg += "\n    -mappable <file-name> (uniquely mappable regions, sorted bed - required with -twopass and -rescore)";
+			msg += "\n    -pass2-minsize <int> (minimum width of hotspots used for pass 2, -rescore, -bed and -wig - default=10)";
+			msg += "\n    -pass2-z <float> (minimum z-score of hotspots used for pass 2, -rescore, -bed and -wig - default=2)";
+			msg += "\n    -pass2-merge <int> (pass-1 hotspots within this distance are merged for pass 2 - default=150)";
+			msg += "\n    -rescore <file-name> <file-name> (instead of calling hotspots, re-score those of pass 1 and pass 2 against the pass-2 background;";
+			msg += "\n        the merged z-scores are written to -o, and requires -pval, -bgtags, -bgmappable, -mappable and -bckntags <pass-1 tag count>)";
+			msg += "\n    -pval <file-name> (with -rescore: output file for the p-values of the merged hotspots)";
+			msg += "\n    -bgtags <file-name> (with -rescore: tags in the pass-2 background, a library file)";
+			msg += "\n    -bgmappable <file-name> (with -rescore: pass-2 background regions, sorted bed)";
+			msg += "\n    -input-tags <file-name> (with -rescore: input tags to subtract from each hotspot, a library file)";
+			msg += "\n    -spot <file-name> (with -rescore and -i <library>: output file for the tags of the library in the hotspots";
+			msg += "\n        of each pass and both, and SPOT, per chromosome and genome-wide)";
 			msg += "\n";
 			std::cerr << msg << std::endl;
 			std::exit( 1 );
@@ -599,22 +1784,55 @@ namespace hotspot
 		else if( std::strcmp( argv[ i ], "-o" ) == 0 )
 		{
 		  std::string outfile = argv[ i + 1 ];
-		  fpout = std::fopen( outfile.c_str( ), "w" );
+		  std::FILE* fp = std::fopen( outfile.c_str( ), "w" );
+		  if( fp == NULL )
+		  {
+			  std::cerr << "Error: unable to access " << outfile << std::endl;
+			  std::exit( EXIT_FAILURE );
+		  }
 		  if( fpout == NULL )
+		  {
+			  outputPath = outfile;
+			  fpout = fp;
+		  }
+		  fpouts.push_back( fp );
+		  i++;
+		}
+		else if( std::strcmp( argv[ i ], "-bed" ) == 0 || std::strcmp( argv[ i ], "-wig" ) == 0 )
+		{
+		  bool wig = ( std::strcmp( argv[ i ], "-wig" ) == 0 );
+		  std::string outfile = argv[ i + 1 ];
+		  std::FILE* fp = std::fopen( outfile.c_str( ), "w" );
+		  if( fp == NULL )
 		  {
 			  std::cerr << "Error: unable to access " << outfile << std::endl;
 			  std::exit( EXIT_FAILURE );
 		  }
+		  if( wig )
+		  {
+			  fpwigs.push_back( fp );
+			  wigTracks.push_back( argv[ i + 2 ] );
+			  i++;
+		  }
+		  else
+		  {
+			  fpbeds.push_back( fp );
+		  }
 		  i++;
 		}
 		else if( std::strcmp(argv[ i ], "-i" ) == 0 )
 		{
-		  libpath = argv[ i + 1 ];
-		  if( access( libpath.c_str( ), R_OK ) )
+		  std::string lib = argv[ i + 1 ];
+		  if( lib != "-" && access( lib.c_str( ), R_OK ) )
 		  {
-			  std::cerr << "Error: unable to access " << libpath << std::endl;
+			  std::cerr << "Error: unable to access " << lib << std::endl;
 			  std::exit( EXIT_FAILURE);
 		  }
+		  if( libPaths.empty( ) )
+		  {
+			  libpath = lib;
+		  }
+		  libPaths.push_back( lib );
 		  i++;
 		}
 		else if( std::strcmp( argv[ i ], "-k" ) == 0 )
@@ -629,17 +1847,20 @@ namespace hotspot
 		}
 		else if( std::strcmp( argv[ i ], "-fuzzy") == 0 )
 		{
-			useFuzzyThreshold = true;
+			// The jittered threshold was never applied, so there is nothing to do
 		}
 		else if( std::strcmp( argv[ i ], "-fuzzy-seed") == 0 )
 		{
-			fuzzySeed = std::atoi( argv[ i + 1 ] );
 			i++;
 		}
 		else if( std::strcmp( argv[ i ], "-gendw" ) == 0 )
 		{
 		  useGenomeDensWin = true;
 		}
+		else if( std::strcmp( argv[ i ], "-pvals" ) == 0 )
+		{
+		  printPValues = true;
+		}
 		else if( std::strcmp( argv[ i ], "-densWin" ) == 0 )
 		{
 		  densityWin = std::atoi( argv[ i + 1 ] );
@@ -650,12 +1871,137 @@ namespace hotspot
 		  mpblGenomeSize = std::atof( argv[ i + 1 ] );
 		  i++;
 		}
+		else if( std::strcmp( argv[ i ], "-threads" ) == 0 )
+		{
+		  numThreads = std::atoi( argv[ i + 1 ] );
+		  i++;
+		}
+		else if( std::strcmp( argv[ i ], "-stats" ) == 0 )
+		{
+		  statsPath = argv[ i + 1 ];
+		  std::FILE* fp = std::fopen( statsPath.c_str( ), "w" );
+		  if( fp == NULL )
+		  {
+			  std::cerr << "Error: unable to access " << statsPath << std::endl;
+			  std::exit( EXIT_FAILURE );
+		  }
+		  std::fclose( fp );
+		  runStats = new RunStats( argc, argv );
+		  i++;
+		}
+		else if( std::strcmp( argv[ i ], "-tagcount" ) == 0 )
+		{
+		  libTagCount = std::atoi( argv[ i + 1 ] );
+		  i++;
+		}
 		else if( std::strcmp( argv[ i ], "-bckntags" ) == 0 )
 		{
 		  useDefaultBackgroundTags = false;
 		  backgroundTotalTagCount = std::atoi( argv[ i + 1 ] );
 		  i++;
 		}
+		else if( std::strcmp( argv[ i ], "-twopass" ) == 0 )
+		{
+		  std::string outfile = argv[ i + 1 ];
+		  fpoutPassTwo = std::fopen( outfile.c_str( ), "w" );
+		  if( fpoutPassTwo == NULL )
+		  {
+			  std::cerr << "Error: unable to access " << outfile << std::endl;
+			  std::exit( EXIT_FAILURE );
+		  }
+		  i++;
+		}
+		else if( std::strcmp( argv[ i ], "-mappable" ) == 0 )
+		{
+			mappableRegionsPath = argv[ i + 1 ];
+			if( access( mappableRegionsPath.c_str( ), R_OK ) )
+			{
+				std::cerr << "Error: unable to access " << mappableRegionsPath << std::endl;
+				std::exit( EXIT_FAILURE );
+			}
+			i++;
+		}
+		else if( std::strcmp( argv[ i ], "-rescore" ) == 0 )
+		{
+			rescorePassOnePath = argv[ i + 1 ];
+			rescorePassTwoPath = argv[ i + 2 ];
+			for( int f = 1; f <= 2; f++ )
+			{
+				if( access( argv[ i + f ], R_OK ) )
+				{
+					std::cerr << "Error: unable to access " << argv[ i + f ] << std::endl;
+					std::exit( EXIT_FAILURE );
+				}
+			}
+			i += 2;
+		}
+		else if( std::strcmp( argv[ i ], "-pval" ) == 0 )
+		{
+		  std::string outfile = argv[ i + 1 ];
+		  fppval = std::fopen( outfile.c_str( ), "w" );
+		  if( fppval == NULL )
+		  {
+			  std::cerr << "Error: unable to access " << outfile << std::endl;
+			  std::exit( EXIT_FAILURE );
+		  }
+		  i++;
+		}
+		else if( std::strcmp( argv[ i ], "-spot" ) == 0 )
+		{
+		  std::string outfile = argv[ i + 1 ];
+		  fpspot = std::fopen( outfile.c_str( ), "w" );
+		  if( fpspot == NULL )
+		  {
+			  std::cerr << "Error: unable to access " << outfile << std::endl;
+			  std::exit( EXIT_FAILURE );
+		  }
+		  i++;
+		}
+		else if( std::strcmp( argv[ i ], "-bgtags" ) == 0 )
+		{
+			backgroundTagsPath = argv[ i + 1 ];
+			if( access( backgroundTagsPath.c_str( ), R_OK ) )
+			{
+				std::cerr << "Error: unable to access " << backgroundTagsPath << std::endl;
+				std::exit( EXIT_FAILURE );
+			}
+			i++;
+		}
+		else if( std::strcmp( argv[ i ], "-bgmappable" ) == 0 )
+		{
+			backgroundRegionsPath = argv[ i + 1 ];
+			if( access( backgroundRegionsPath.c_str( ), R_OK ) )
+			{
+				std::cerr << "Error: unable to access " << backgroundRegionsPath << std::endl;
+				std::exit( EXIT_FAILURE );
+			}
+			i++;
+		}
+		else if( std::strcmp( argv[ i ], "-input-tags" ) == 0 )
+		{
+			inputTagsPath = argv[ i + 1 ];
+			if( access( inputTagsPath.c_str( ), R_OK ) )
+			{
+				std::cerr << "Error: unable to access " << inputTagsPath << std::endl;
+				std::exit( EXIT_FAILURE );
+			}
+			i++;
+		}
+		else if( std::strcmp( argv[ i ], "-pass2-minsize" ) == 0 )
+		{
+		  passTwoMinSize = std::atoi( argv[ i + 1 ] );
+		  i++;
+		}
+		else if( std::strcmp( argv[ i ], "-pass2-z" ) == 0 )
+		{
+		  passTwoZThresh = std::atof( argv[ i + 1 ] );
+		  i++;
+		}
+		else if( std::strcmp( argv[ i ], "-pass2-merge" ) == 0 )
+		{
+		  passTwoMergeDist = std::atoi( argv[ i + 1 ] );
+		  i++;
+		}
 		else
 		{
 			std::cerr << "Unrecognized option: " << argv[ i ] << ". Aborting." << std::endl;
@@ -670,6 +2016,46 @@ namespace hotspot
 		  std::cerr << "Output file required" << std::endl;
 		  std::exit( EXIT_FAILURE);
 	  }
+	  if( libPaths.size( ) > 1 && ( libPaths.size( ) != fpouts.size( ) || fpoutPassTwo != NULL
+			  || ! rescorePassOnePath.empty( ) || libTagCount >= 0 ) )
+	  {
+		  std::cerr << "Several -i files each need their own -o file, and cannot be used with -twopass, -rescore or -tagcount" << std::endl;
+		  std::exit( EXIT_FAILURE );
+	  }
+	  if( fpoutPassTwo != NULL && mappableRegionsPath.empty( ) )
+	  {
+		  std::cerr << "-mappable file required with -twopass" << std::endl;
+		  std::exit( EXIT_FAILURE );
+	  }
+	  if( ! rescorePassOnePath.empty( ) && ( fppval == NULL || backgroundTagsPath.empty( )
+			  || backgroundRegionsPath.empty( ) || mappableRegionsPath.empty( ) || useDefaultBackgroundTags ) )
+	  {
+		  std::cerr << "-pval, -bgtags, -bgmappable, -mappable and -bckntags required with -rescore" << std::endl;
+		  std::exit( EXIT_FAILURE );
+	  }
+	  if( fpspot != NULL && ( rescorePassOnePath.empty( ) || libPaths.size( ) != 1 ) )
+	  {
+		  std::cerr << "-spot requires -rescore, and the library as the one -i file" << std::endl;
+		  std::exit( EXIT_FAILURE );
+	  }
+	  if( ( ! fpbeds.empty( ) && fpbeds.size( ) != fpouts.size( ) )
+		  || ( ! fpwigs.empty( ) && fpwigs.size( ) != fpouts.size( ) ) )
+	  {
+		  std::cerr << "-bed and -wig are each needed once for every -o file, in the same order" << std::endl;
+		  std::exit( EXIT_FAILURE );
+	  }
+	  if( ( ! fpbeds.empty( ) || ! fpwigs.empty( ) ) && ! rescorePassOnePath.empty( ) )
+	  {
+		  std::cerr << "-bed and -wig cannot be used with -rescore" << std::endl;
+		  std::exit( EXIT_FAILURE );
+	  }
+	  if( ! fpbeds.empty( ) || ! fpwigs.empty( ) )
+	  {
+		  for( unsigned int l = 0; l < fpouts.size( ); l++ )
+		  {
+			  hotspotBeds.push_back( new HotspotBed( passTwoMinSize, passTwoZThresh ) );
+		  }
+	  }
 	  return;
 	}
 } // namespace
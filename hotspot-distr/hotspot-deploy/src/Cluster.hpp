@@ -16,36 +16,102 @@
 #ifndef __CLUSTER_H__
 #define __CLUSTER_H__
 
-#include <map>
+#include <cstdio>
+#include <ostream>
+#include <string>
 #include <vector>
 #include "HotspotDefaults.hpp"
 #include "Hotspot.hpp"
+#include "HotspotTable.hpp"
+#include "RunStats.hpp"
 
 namespace hotspot
 {
+	class InputDataReader;
+	class MappableCountsDataReader;
+
 	// Process program Input
 	void GetArgs (int argc, char **argv);
 
 	// Background data Input
+	// Prefix sums over the background bins, for constant-time window sums
+	struct MappableSums
+	{
+		std::vector< int > sites;    // sites[j]: sum of bins 0..j-1, each capped at densityWinSmall
+		std::vector< int > overfull; // overfull[j]: number of bins in 0..j-1 over densityWinSmall
+	};
+	void BuildMappableSums( const std::vector< int >& mappableCounts, int densityWinSmall,
+							MappableSums& sums );
 	int countMappableSites( int base, int densityWin, int densityWinSmall,
-							const std::vector< int >& mappableCounts );
+							const std::vector< int >& mappableCounts, const MappableSums& sums, std::ostream& log );
+	// Detection parameters for one scan window size; see ComputeWindowThresholds
+	struct WindowThreshold
+	{
+		int winsize;
+		int halfWidth; // tags in [pos - halfWidth, pos + halfWidth] fall in a window centered on pos
+		double prob;
+		double mean;
+		double sd;
+		double detectThresh;
+		int minCount; // smallest tag count that exceeds detectThresh
+		int totalTags; // tags in the library, for the discrepancy
+	};
+
+	// Tallies of which density window scored each cluster under -gendw.
+	// Kept per chromosome so chromosomes can be scored concurrently.
+	struct DensityWindowStats
+	{
+		int numGenomeDens;
+		int numLocalDens;
+		double genomeDensZ;
+		double localDensZ;
+
+		DensityWindowStats( )
+			: numGenomeDens( 0 ), numLocalDens( 0 ), genomeDensZ( 0.0 ), localDensZ( 0.0 )
+		{ }
+	};
+
+	// The tag counts a library is scored against.  Each library of a run
+	// with several -i files has its own.
+	struct TagCounts
+	{
+		int total;      // tags in the library, for the window thresholds
+		int background; // tags for the genome-wide background (-bckntags)
+	};
+
+	// Run all clustering stages on one chromosome, using <arena> for working
+	// storage, and write hotspots to <out> and progress messages to <log>.
+	// With <stats>, each stage is timed and its counts are recorded there.
+	void ProcessChrom( const std::string& chromName, const std::vector< int >& inputData,
+					   const std::vector< int >& mappableCounts, const TagCounts& counts,
+					   HotspotArena& arena, std::FILE* out, std::ostream& log,
+					   ChromStats* stats = NULL );
+
+	// Read and process the chromosomes a chunk of tags at a time, holding only the
+	// tags that pending hotspots can reach, and write each hotspot as soon as no
+	// later tag can change it.  Returns the number of tags read.
+	int ProcessChromsStreaming( InputDataReader& inputDataReader,
+								MappableCountsDataReader& mappableCountsDataReader );
+
 	// Clustering calculations
-	double calculateZScore( int basesSpannedByCluster, int numSitesInCluster,
-							int densityWindowSize, int numSitesInDensityWindow, int mappableSites );
+	void ComputeWindowThresholds( int winLow, int winHigh, int winInc, int totalTags,
+								  std::vector< WindowThreshold >& thresholds );
+	void ScoreClusters( HotspotTable& clusters, int first, int last, int backgroundTags,
+						DensityWindowStats& densStats );
 	int countDensity2( int base, const std::vector< int >& inputData );
 	double ComputeHotSpots( const std::vector<int>& inputData, int winLow, int winHigh,
-							int winInc, std::map< int, Hotspot* >& hotspots );
-	void FilterHotspots( const std::map<int, Hotspot* >& hotspots,
-						 std::map< int, Hotspot* >& filteredHotspots );
-	void ClusterSize( const std::vector<int>& inputData, int densityWin, std::map< int, Hotspot* >& filteredHotspots,
-					  const std::vector< int >& mappableCounts );
-
-	// Input arguments
-	int totaltagcount, densityWin, fuzzySeed;
-	int lowInt, highInt, incInt;
-	double numSD, genomeSize;
-	std::string outputFileName;
-	FILE *fpout; // file associated with outputFileName
+							int winInc, int totalTags, HotspotTable& hotspots );
+	void FilterHotspots( const HotspotTable& hotspots, HotspotTable& filteredHotspots );
+	void ClusterSize( const std::vector<int>& inputData, int densityWin, HotspotTable& filteredHotspots,
+					  const std::vector< int >& mappableCounts, int backgroundTags, DensityWindowStats& densStats,
+					  std::ostream& log );
+
+	// Input arguments, defined in Cluster.cpp
+	extern int totaltagcount, densityWin;
+	extern int lowInt, highInt, incInt;
+	extern double numSD, genomeSize;
+	extern std::string outputFileName;
+	extern FILE *fpout; // file associated with outputFileName
 }
 
 #endif // __CLUSTER_H__
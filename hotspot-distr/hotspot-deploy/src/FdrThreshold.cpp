@@ -0,0 +1,103 @@
+/**
+ * File: FdrThreshold.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  An implementation of FdrThreshold.hpp
+ */
+
+#include "FdrThreshold.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace hotspot
+{
+	/**
+	 * Random over observed hotspots; none of either counts as no false discoveries
+	 */
+	static double EmpiricalFdr( int numObserved, int numRandom )
+	{
+		if( numObserved == 0 )
+		{
+			return ( numRandom == 0 ) ? 0.0 : HUGE_VAL;
+		}
+		return static_cast< double >( numRandom ) / numObserved;
+	}
+
+	FdrCurve::FdrCurve( std::vector< double >& observed, std::vector< double >& random, double low, double high )
+	{
+		_observed.swap( observed );
+		_random.swap( random );
+		std::sort( _observed.begin( ), _observed.end( ) );
+		std::sort( _random.begin( ), _random.end( ) );
+
+		// Step up through the z-scores of both sets at once.  o and r are always
+		// at the first z-score of each set above the current break.
+		std::vector< double >::const_iterator o = std::upper_bound( _observed.begin( ), _observed.end( ), low );
+		std::vector< double >::const_iterator r = std::upper_bound( _random.begin( ), _random.end( ), low );
+		std::vector< double > fdr;
+		double z = low;
+		while( true )
+		{
+			_breaks.push_back( z );
+			fdr.push_back( EmpiricalFdr( _observed.end( ) - o, _random.end( ) - r ) );
+			z = high;
+			if( o != _observed.end( ) && *o < z )
+			{
+				z = *o;
+			}
+			if( r != _random.end( ) && *r < z )
+			{
+				z = *r;
+			}
+			if( ! ( z < high ) )
+			{
+				break;
+			}
+			while( o != _observed.end( ) && *o <= z )
+			{
+				++o;
+			}
+			while( r != _random.end( ) && *r <= z )
+			{
+				++r;
+			}
+		}
+
+		_maxFdr.resize( fdr.size( ) );
+		double maxFdr = 0.0;
+		for( int k = fdr.size( ) - 1; k >= 0; k-- )
+		{
+			maxFdr = std::max( maxFdr, fdr[k] );
+			_maxFdr[k] = maxFdr;
+		}
+	}
+
+	bool FdrCurve::threshold( double fdr, double& threshold ) const
+	{
+		if( fdr == 0 )
+		{
+			threshold = _random.empty( ) ? -HUGE_VAL : _random.back( );
+			return true;
+		}
+
+		// _maxFdr never rises from one break to the next
+		std::vector< double >::const_iterator k = std::lower_bound( _maxFdr.begin( ), _maxFdr.end( ), fdr,
+																	std::greater< double >( ) );
+		if( k == _maxFdr.end( ) )
+		{
+			return false;
+		}
+		threshold = _breaks[ k - _maxFdr.begin( ) ];
+		return true;
+	}
+
+	int FdrCurve::numAbove( double threshold ) const
+	{
+		return _observed.end( ) - std::upper_bound( _observed.begin( ), _observed.end( ), threshold );
+	}
+}
@@ -0,0 +1,57 @@
+/**
+ * File: FdrThreshold.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  FDR thresholds for hotspots, in place of run_thresh_hot.R.  The
+ *  empirical FDR of a z-score threshold is the number of random-library
+ *  hotspots scoring above it over the number of observed hotspots
+ *  scoring above it.  It only changes at the z-scores themselves, so
+ *  both sets are sorted once and the FDR is found for every stretch
+ *  between consecutive z-scores in one merge pass.  Any number of FDR
+ *  levels are then looked up by binary search.
+ */
+
+#ifndef FDR_THRESHOLD_HPP_
+#define FDR_THRESHOLD_HPP_
+
+#include <vector>
+
+namespace hotspot
+{
+
+	class FdrCurve
+	{
+	public:
+		/**
+		 * The empirical FDR of the <observed> z-scores against the <random>
+		 * ones, for thresholds from <low> to <high>.  The z-score vectors are
+		 * taken over, and left empty.
+		 */
+		FdrCurve( std::vector< double >& observed, std::vector< double >& random, double low, double high );
+
+		/**
+		 * The lowest threshold from low to high above which the FDR is never
+		 * more than <fdr>, into <threshold>.  As in run_thresh_hot.R, an FDR of
+		 * 0 gives the highest random z-score instead.  Returns false if the FDR
+		 * is more than <fdr> even at high.
+		 */
+		bool threshold( double fdr, double& threshold ) const;
+
+		/**
+		 * Number of observed z-scores above <threshold>
+		 */
+		int numAbove( double threshold ) const;
+
+	private:
+		std::vector< double > _observed; // ascending
+		std::vector< double > _random;   // ascending
+		std::vector< double > _breaks;   // the FDR is constant from each break up to the next
+		std::vector< double > _maxFdr;   // highest FDR from each break up to high
+	};
+
+} // namespace hotspot
+
+#endif /* FDR_THRESHOLD_HPP_ */
@@ -0,0 +1,277 @@
+/**
+ * File: FdrThresholder.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  Entry point of hotspot-fdr, which thresholds the twopass.zscore.wig
+ *  hotspots of a library at each of a list of FDR levels, estimated
+ *  against the hotspots of its random library (see FdrThreshold.hpp), in
+ *  place of run_thresh_hot.R.  For each level it writes the hotspots
+ *  above the threshold as <name>.hotspot.twopass.fdr<level>.wig and .bed,
+ *  and those within the merge distance of each other merged, with the
+ *  highest z-score, as .merge.wig, as the bedops and bedmap steps of the
+ *  R script did.
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ByLine.hpp"
+#include "FdrThreshold.hpp"
+#include "HotspotDefaults.hpp"
+#include "IntervalSet.hpp"
+
+namespace hotspot
+{
+	struct WigRow
+	{
+		int chrom; // index into the chromosome names
+		int start;
+		int end;
+		double z;
+		std::string zText; // as read, to be written back unchanged
+	};
+
+	/**
+	 * Read the rows of the z-score track <fileName>, skipping its track line.
+	 * The z-scores go to <z>, and if <rows> is not NULL, the rows to <rows>
+	 * with their chromosome names in <chromNames>, in order of appearance.
+	 * Returns false, after reporting why, on error.
+	 */
+	bool ReadZScores( const std::string& fileName, std::vector< double >& z,
+					  std::vector< WigRow >* rows, std::vector< std::string >* chromNames )
+	{
+		std::ifstream in( fileName.c_str( ) );
+		if( ! in )
+		{
+			std::fprintf( stderr, "Error: unable to access %s\n", fileName.c_str( ) );
+			return false;
+		}
+
+		int nameStart, nameEnd, zStart, zEnd;
+		WigRow row;
+		int lineNum = 0;
+		ByLine line;
+		while( in >> line )
+		{
+			lineNum++;
+			if( lineNum == 1 || line.empty( ) )
+			{
+				continue;
+			}
+			// The name and z-score are located rather than copied, so neither has a length limit
+			if( std::sscanf( line.c_str( ), " %n%*s%n %d %d %n%*s%n", &nameStart, &nameEnd,
+							 &row.start, &row.end, &zStart, &zEnd ) != 2 )
+			{
+				std::fprintf( stderr, "Error: input file %s contains a malformed entry on line %d\n",
+						fileName.c_str( ), lineNum );
+				return false;
+			}
+			std::string chromName( line, nameStart, nameEnd - nameStart );
+			std::string zText( line, zStart, zEnd - zStart );
+			row.z = std::strtod( zText.c_str( ), NULL );
+			z.push_back( row.z );
+			if( rows != NULL )
+			{
+				if( chromNames->empty( ) || chromNames->back( ) != chromName )
+				{
+					chromNames->push_back( chromName );
+				}
+				row.chrom = chromNames->size( ) - 1;
+				row.zText = zText;
+				rows->push_back( row );
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Write the rows of <rows> above <threshold> to <wig>, after a track line
+	 * naming <trackName>, and to <bed>; then merge those within <mergeDist>
+	 * of each other and write them, with the highest z-score of each, to
+	 * <mergeWig>.  Returns false if a file cannot be written.
+	 */
+	bool WriteThresholded( const std::vector< WigRow >& rows, const std::vector< std::string >& chromNames,
+						   double threshold, int mergeDist, const std::string& trackName,
+						   std::FILE* wig, std::FILE* bed, std::FILE* mergeWig )
+	{
+		std::fprintf( wig, "track type=wiggle_0 visibility=full name=%s\n", trackName.c_str( ) );
+		std::fprintf( mergeWig, "track type=wiggle_0 visibility=full name=%s\n", trackName.c_str( ) );
+		int pad = mergeDist / 2;
+		unsigned int i = 0;
+		while( i < rows.size( ) )
+		{
+			// One chromosome at a time
+			int chrom = rows[i].chrom;
+			const char* chromName = chromNames[ chrom ].c_str( );
+			IntervalSet merged;
+			std::vector< const WigRow* > kept;
+			for( ; i < rows.size( ) && rows[i].chrom == chrom; i++ )
+			{
+				const WigRow& row = rows[i];
+				if( ! ( row.z > threshold ) )
+				{
+					continue;
+				}
+				std::fprintf( wig, "%s\t%d\t%d\t%s\n", chromName, row.start, row.end, row.zText.c_str( ) );
+				std::fprintf( bed, "%s\t%d\t%d\t%s\n", chromName, row.start, row.end, row.zText.c_str( ) );
+				merged.add( row.start, row.end );
+				kept.push_back( &row );
+			}
+			if( kept.empty( ) )
+			{
+				continue;
+			}
+
+			merged.pad( pad );
+			merged.shrink( pad );
+			const std::vector< Interval >& intervals = merged.intervals( );
+			std::vector< double > maxZ( intervals.size( ), -HUGE_VAL );
+			for( unsigned int k = 0; k < kept.size( ); k++ )
+			{
+				int m = std::upper_bound( intervals.begin( ), intervals.end( ), Interval( kept[k]->start, INT_MAX ) )
+						- intervals.begin( ) - 1;
+				maxZ[m] = std::max( maxZ[m], kept[k]->z );
+			}
+			for( unsigned int m = 0; m < intervals.size( ); m++ )
+			{
+				std::fprintf( mergeWig, "%s\t%d\t%d\t%f\n", chromName, intervals[m].start, intervals[m].end, maxZ[m] );
+			}
+		}
+		return ! std::ferror( wig ) && ! std::ferror( bed ) && ! std::ferror( mergeWig );
+	}
+}
+
+int main( int argc, char **argv )
+{
+	std::string observedPath, randomPath, fdrList, name, outputDir = ".";
+	int mergeDist = hotspot::HotspotDefaults::PASS2_MERGE_DIST;
+	double zMin = hotspot::HotspotDefaults::FDR_Z_MIN;
+	double zMax = hotspot::HotspotDefaults::FDR_Z_MAX;
+	for( int i = 1; i < argc; i++ )
+	{
+		bool hasValue = ( i + 1 < argc );
+		if( std::strcmp( argv[ i ], "-observed" ) == 0 && hasValue )
+		{
+			observedPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-random" ) == 0 && hasValue )
+		{
+			randomPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-fdrs" ) == 0 && hasValue )
+		{
+			fdrList = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-name" ) == 0 && hasValue )
+		{
+			name = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-outdir" ) == 0 && hasValue )
+		{
+			outputDir = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-merge" ) == 0 && hasValue )
+		{
+			mergeDist = std::atoi( argv[ ++i ] );
+		}
+		else if( std::strcmp( argv[ i ], "-range" ) == 0 && i + 2 < argc )
+		{
+			zMin = std::atof( argv[ ++i ] );
+			zMax = std::atof( argv[ ++i ] );
+		}
+		else
+		{
+			std::cerr << "Unrecognized option: " << argv[ i ] << ". Aborting." << std::endl;
+			std::exit( EXIT_FAILURE );
+		}
+	}
+	if( observedPath.empty( ) || randomPath.empty( ) || fdrList.empty( ) || name.empty( ) )
+	{
+		std::string msg  = "Usage: hotspot-fdr -observed <file-name> -random <file-name> -fdrs <levels> -name <name> [options]";
+		msg += "\n    -observed <file-name> (twopass.zscore.wig hotspots of the library)";
+		msg += "\n    -random <file-name> (twopass.zscore.wig hotspots of its random library)";
+		msg += "\n    -fdrs <levels> (FDR levels, separated by spaces; N is skipped)";
+		msg += "\n    -name <name> (library name, for output file and track names)";
+		msg += "\n    -outdir <directory> (for the output files - default=.)";
+		msg += "\n    -merge <int> (thresholded hotspots within this distance are merged - default=150)";
+		msg += "\n    -range <float> <float> (lowest and highest z-score thresholds considered - default=3 35)";
+		msg += "\n";
+		std::cerr << msg << std::endl;
+		std::exit( EXIT_FAILURE );
+	}
+
+	std::vector< double > observedZ, randomZ;
+	std::vector< hotspot::WigRow > rows;
+	std::vector< std::string > chromNames;
+	if( ! hotspot::ReadZScores( observedPath, observedZ, &rows, &chromNames )
+		|| ! hotspot::ReadZScores( randomPath, randomZ, NULL, NULL ) )
+	{
+		std::exit( EXIT_FAILURE );
+	}
+	hotspot::FdrCurve curve( observedZ, randomZ, zMin, zMax );
+
+	std::istringstream levels( fdrList );
+	std::string level;
+	while( levels >> level )
+	{
+		if( level == "N" )
+		{
+			continue;
+		}
+		char* end;
+		double fdr = std::strtod( level.c_str( ), &end );
+		if( *end != '\0' )
+		{
+			std::cerr << "Warning: non-numeric value for fdr: " << level << std::endl;
+			continue;
+		}
+		double threshold;
+		if( ! curve.threshold( fdr, threshold ) )
+		{
+			std::cerr << "Warning: the FDR is above " << level << " for every z-score threshold up to "
+					  << zMax << "; skipping" << std::endl;
+			continue;
+		}
+		char fdrText[64];
+		std::snprintf( fdrText, sizeof( fdrText ), "%.15g", fdr );
+		std::printf( "fdr %s z-score threshold = %.7g -- number of thresholded hotspots = %d\n",
+				fdrText, threshold, curve.numAbove( threshold ) );
+
+		std::string base = outputDir + "/" + name + ".hotspot.twopass.fdr" + fdrText;
+		std::string trackName = name + ".hotspot.fdr" + fdrText;
+		std::string fileNames[3] = { base + ".wig", base + ".bed", base + ".merge.wig" };
+		std::FILE* fp[3];
+		for( int f = 0; f < 3; f++ )
+		{
+			fp[f] = std::fopen( fileNames[f].c_str( ), "w" );
+			if( fp[f] == NULL )
+			{
+				std::fprintf( stderr, "Error: unable to open %s\n", fileNames[f].c_str( ) );
+				std::exit( EXIT_FAILURE );
+			}
+		}
+		bool ok = hotspot::WriteThresholded( rows, chromNames, threshold, mergeDist, trackName, fp[0], fp[1], fp[2] );
+		for( int f = 0; f < 3; f++ )
+		{
+			ok = ( std::fclose( fp[f] ) == 0 ) && ok;
+		}
+		if( ! ok )
+		{
+			std::fprintf( stderr, "Error: unable to write %s\n", base.c_str( ) );
+			std::exit( EXIT_FAILURE );
+		}
+	}
+	std::exit( EXIT_SUCCESS );
+}
@@ -11,6 +11,8 @@
 #include <cstdio>
 #include <iostream>
 #include "Hotspot.hpp"
+#include "HotspotTable.hpp"
+#include "OutputBuffer.hpp"
 
 void Hotspot::printHeaderVerbose( std::FILE *outputFile )
 {
@@ -23,35 +25,60 @@ void Hotspot::printHeaderVerbose( std::FILE *outputFile )
 }
 
 
-void Hotspot::printOutVerbose( const char *chrom, std::FILE *fp )
+void Hotspot::printOutVerbose( const hotspot::HotspotTable& t, int i,
+                               const char *chrom, std::FILE *fp )
 {
   if( fp == NULL || chrom == NULL )
     {
       return;
     }
   std::fprintf( fp, "%s\t%d\t%5.2f\t%5.2f\t%d\t%d\t%f\t%5f\t%d\t%d\t%f\t%d\t%d\t%d\t%d\n",
-		chrom, averagePos, densCount,
-		weightedAvgSD, filterSize, filterDist,
-		filteredZScore, filterWidth, minSite, maxSite, filteredZScoreAdjusted,
-		filterIndexLeft, filterIndexRight, filterDensIndexLeft,
-		filterDensIndexRight );
+		chrom, t.averagePos[i], t.densCount[i],
+		t.weightedAvgSD[i], t.filterSize[i], t.filterDist[i],
+		t.filteredZScore[i], t.filterWidth[i], t.minSite[i], t.maxSite[i], t.filteredZScoreAdjusted[i],
+		t.filterIndexLeft[i], t.filterIndexRight[i], t.filterDensIndexLeft[i],
+		t.filterDensIndexRight[i] );
 }
 
-void Hotspot::printHeader( std::FILE *outputFile )
+void Hotspot::printHeader( std::FILE *outputFile, bool pValues, bool genomePValues )
 {
   if( outputFile == NULL )
     {
       return;
     }
-  std::fprintf( outputFile, "Chrome\tPosition\tClusterSize\tInterDist\tWindowWidth\tMinSite\tMaxSite\tZScore2\n" );
+  std::fprintf( outputFile, "Chrome\tPosition\tClusterSize\tInterDist\tWindowWidth\tMinSite\tMaxSite\tZScore2%s%s\n",
+		pValues ? "\tPValue" : "", genomePValues ? "\tPValueGenome" : "" );
 }
 
-void Hotspot::printOut( const char *chrom, FILE *fp )
+void Hotspot::printOut( const hotspot::HotspotTable& t, int i,
+                        const std::string& chrom, hotspot::OutputBuffer& out,
+                        bool pValues, bool genomePValues )
 {
-  if( fp == NULL || chrom == NULL )
+  // %5f is never wider than %f, whose six places make eight characters at least
+  out.append( chrom );
+  out.append( '\t' );
+  out.appendInt( t.averagePos[i] );
+  out.append( '\t' );
+  out.appendInt( t.filterSize[i] );
+  out.append( '\t' );
+  out.appendInt( t.filterDist[i] );
+  out.append( '\t' );
+  out.appendFixed( t.filterWidth[i] );
+  out.append( '\t' );
+  out.appendInt( t.minSite[i] );
+  out.append( '\t' );
+  out.appendInt( t.maxSite[i] );
+  out.append( '\t' );
+  out.appendFixed( t.filteredZScoreAdjusted[i] );
+  if( pValues )
     {
-      return;
+      out.append( '\t' );
+      out.appendExp( t.pValue[i] );
+    }
+  if( genomePValues )
+    {
+      out.append( '\t' );
+      out.appendExp( t.pValueGenome[i] );
     }
-  std::fprintf( fp, "%s\t%d\t%d\t%d\t%5f\t%d\t%d\t%f\n",
-		chrom, averagePos, filterSize, filterDist, filterWidth, minSite, maxSite, filteredZScoreAdjusted );
+  out.append( '\n' );
 }
@@ -13,6 +13,13 @@
 #define HOTSPOT_HPP_
 
 #include <cstdio>
+#include <string>
+
+namespace hotspot
+{
+  class HotspotTable;
+  class OutputBuffer;
+}
 
 struct Hotspot
 {
@@ -33,6 +40,13 @@ struct Hotspot
   double filteredZScore;
   double filteredZScoreAdjusted;
   double weightedAvgSD;
+  double pValue;
+  double pValueGenome;
+
+  // Scoring: bases spanned, and tags and mappable sites in the density window
+  int spannedBases;
+  int densTags;
+  int mappableSites;
 
   // Background data
   double densCount;
@@ -55,6 +69,11 @@ struct Hotspot
       filteredZScore( 0.0 ),
       filteredZScoreAdjusted( 0.0 ),
       weightedAvgSD( 0.0 ),
+      pValue( 1.0 ),
+      pValueGenome( 1.0 ),
+      spannedBases( 0 ),
+      densTags( 0 ),
+      mappableSites( 0 ),
       densCount( 0.0 )
   { /* */ }
 
@@ -64,21 +83,28 @@ struct Hotspot
   static void printHeaderVerbose( std::FILE *fp );
 
   /**
-   * Write detailed information about this object to <fp>,
+   * Write detailed information about row <row> of <table> to <fp>,
    *  with a column associating the hotspot with <chrom>
    */
-  void printOutVerbose( const char* chrom, std::FILE* fp );
+  static void printOutVerbose( const hotspot::HotspotTable& table, int row,
+                               const char* chrom, std::FILE* fp );
 
   /**
-   * Write a header to <fp>
+   * Write a header to <fp>, with a PValue column if <pValues>, and
+   *  a PValueGenome column after it if <genomePValues>
    */
-  static void printHeader( std::FILE *fp );
+  static void printHeader( std::FILE *fp, bool pValues = false, bool genomePValues = false );
 
   /**
-   * Write information about this object to <fp>,
-   *  with a column associating the hotspot with <chrom>
+   * Append information about row <row> of <table> to <out>,
+   *  with a column associating the hotspot with <chrom>, and
+   *  its local p-value last if <pValues>, followed by its
+   *  genome-wide p-value if <genomePValues>.  It reads as printf's
+   *  "%s\t%d\t%d\t%d\t%5f\t%d\t%d\t%f\t%e\t%e".
    */
-  void printOut( const char* chrom, std::FILE* fp );
+  static void printOut( const hotspot::HotspotTable& table, int row,
+                        const std::string& chrom, hotspot::OutputBuffer& out,
+                        bool pValues = false, bool genomePValues = false );
 };
 
 #endif /* HOTSPOT_HPP_ */
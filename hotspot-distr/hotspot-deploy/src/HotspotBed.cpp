@@ -0,0 +1,185 @@
+/**
+ * File: HotspotBed.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  An implementation of HotspotBed.hpp
+ */
+
+#include "HotspotBed.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "OutputBuffer.hpp"
+
+namespace hotspot
+{
+	// The order sort-bed gives the rows: by chromosome name, start and end.
+	// Rows the same in all three stay in the order of the output file.
+	struct BedOrder
+	{
+		int rank;  // of the chromosome's name
+		int start;
+		int end;
+		int chunk;
+		int line;
+		unsigned int row;
+
+		bool operator<( const BedOrder& other ) const
+		{
+			if( rank != other.rank )
+			{
+				return rank < other.rank;
+			}
+			if( start != other.start )
+			{
+				return start < other.start;
+			}
+			if( end != other.end )
+			{
+				return end < other.end;
+			}
+			if( chunk != other.chunk )
+			{
+				return chunk < other.chunk;
+			}
+			return line < other.line;
+		}
+	};
+
+	// Chunks ordered by chromosome name, as strcmp orders them
+	struct ChromNameOrder
+	{
+		const std::vector< std::string >* names;
+
+		bool operator( )( int a, int b ) const
+		{
+			return ( *names )[a] < ( *names )[b];
+		}
+	};
+
+	HotspotBed::HotspotBed( int minSize, double zThresh ) : _minSize( minSize ), _zThresh( zThresh )
+	{
+		pthread_mutex_init( &_lock, NULL );
+	}
+
+	HotspotBed::~HotspotBed( )
+	{
+		pthread_mutex_destroy( &_lock );
+	}
+
+	void HotspotBed::add( int chunk, const std::string& chrom, const HotspotTable& hotspots, int first, int last )
+	{
+		// The z-score is compared as the output file has it
+		std::vector< Row > rows;
+		OutputBuffer zText;
+		for( int i = first; i < last; i++ )
+		{
+			if( hotspots.maxSite[i] - hotspots.minSite[i] + 1 < _minSize )
+			{
+				continue;
+			}
+			zText.clear( );
+			zText.appendFixed( hotspots.filteredZScoreAdjusted[i] );
+			double z = std::strtod( zText.c_str( ), NULL );
+			if( ! ( z > _zThresh ) || std::isinf( z ) )
+			{
+				continue;
+			}
+			Row row;
+			row.chunk = chunk;
+			row.line = i - first;
+			row.start = hotspots.minSite[i];
+			row.end = hotspots.maxSite[i] + 1;
+			row.zScore = zText.c_str( );
+			rows.push_back( row );
+		}
+
+		pthread_mutex_lock( &_lock );
+		if( chunk >= static_cast< int >( _chunks.size( ) ) )
+		{
+			Chunk empty;
+			empty.numHotspots = 0;
+			_chunks.resize( chunk + 1, empty );
+		}
+		Chunk& added = _chunks[ chunk ];
+		added.chrom = chrom;
+		for( unsigned int r = 0; r < rows.size( ); r++ )
+		{
+			rows[r].line += added.numHotspots;
+		}
+		added.numHotspots += last - first;
+		_rows.insert( _rows.end( ), rows.begin( ), rows.end( ) );
+		pthread_mutex_unlock( &_lock );
+	}
+
+	bool HotspotBed::write( std::FILE* fp, const std::string& trackName ) const
+	{
+		// Rows are numbered by their line of the output file, after its header
+		std::vector< long long > firstLine( _chunks.size( ), 2 );
+		std::vector< std::string > names( _chunks.size( ) );
+		std::vector< int > byName( _chunks.size( ) );
+		for( unsigned int c = 0; c < _chunks.size( ); c++ )
+		{
+			if( c > 0 )
+			{
+				firstLine[c] = firstLine[c - 1] + _chunks[c - 1].numHotspots;
+			}
+			names[c] = _chunks[c].chrom;
+			byName[c] = c;
+		}
+		ChromNameOrder nameOrder;
+		nameOrder.names = &names;
+		std::stable_sort( byName.begin( ), byName.end( ), nameOrder );
+		std::vector< int > rank( _chunks.size( ) );
+		for( unsigned int c = 0; c < byName.size( ); c++ )
+		{
+			rank[ byName[c] ] = c;
+		}
+
+		std::vector< BedOrder > order( _rows.size( ) );
+		for( unsigned int r = 0; r < _rows.size( ); r++ )
+		{
+			const Row& row = _rows[r];
+			order[r].rank = rank[ row.chunk ];
+			order[r].start = row.start;
+			order[r].end = row.end;
+			order[r].chunk = row.chunk;
+			order[r].line = row.line;
+			order[r].row = r;
+		}
+		std::sort( order.begin( ), order.end( ) );
+
+		OutputBuffer out;
+		if( ! trackName.empty( ) )
+		{
+			out.append( "track visibility=dense name=" );
+			out.append( trackName );
+			out.append( '\n' );
+		}
+		for( unsigned int r = 0; r < order.size( ); r++ )
+		{
+			const Row& row = _rows[ order[r].row ];
+			out.append( _chunks[ row.chunk ].chrom );
+			out.append( '\t' );
+			out.appendInt( row.start );
+			out.append( '\t' );
+			out.appendInt( row.end );
+			out.append( "\tid-" );
+			out.appendInt( firstLine[ row.chunk ] + row.line );
+			out.append( '\t' );
+			out.append( row.zScore );
+			out.append( '\n' );
+		}
+		if( ! out.writeTo( fp ) || std::fflush( fp ) != 0 )
+		{
+			std::fprintf( stderr, "Error: unable to write the hotspot bed file\n" );
+			return false;
+		}
+		return true;
+	}
+}
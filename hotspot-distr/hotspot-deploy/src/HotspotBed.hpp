@@ -0,0 +1,79 @@
+/**
+ * File: HotspotBed.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  The hotspots of one output file as a sorted bed file, made as
+ *  run_pass1_merge_and_thresh_hotspots makes it from the output file:
+ *  those at least a minimum width, with a z-score, as printed, above a
+ *  threshold and neither nan nor inf, as
+ *
+ *      chrom  MinSite  MaxSite+1  id-<line of the output file>  ZScore2
+ *
+ *  sorted by chromosome name, then position, as sort-bed sorts them.
+ *  Chromosomes may be added in any order, from any thread.
+ */
+
+#ifndef HOTSPOT_BED_HPP_
+#define HOTSPOT_BED_HPP_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+#include "HotspotTable.hpp"
+
+namespace hotspot
+{
+
+	class HotspotBed
+	{
+	public:
+		HotspotBed( int minSize, double zThresh );
+		~HotspotBed( );
+
+		/**
+		 * Add rows <first> to <last> - 1 of <hotspots>, the next to be written
+		 * for chromosome <chrom>, which is chunk number <chunk> of the output
+		 */
+		void add( int chunk, const std::string& chrom, const HotspotTable& hotspots, int first, int last );
+
+		/**
+		 * Write the bed file to <fp>, headed by a track line named <trackName>
+		 * unless it is empty.  Returns false, having reported the error, if it
+		 * could not be written.
+		 */
+		bool write( std::FILE* fp, const std::string& trackName ) const;
+
+	private:
+		HotspotBed( const HotspotBed& );
+		HotspotBed& operator=( const HotspotBed& );
+
+		struct Chunk
+		{
+			std::string chrom;
+			int numHotspots; // rows in the output file, kept or not
+		};
+
+		struct Row
+		{
+			int chunk;
+			int line;  // row of the chunk
+			int start;
+			int end;
+			std::string zScore;
+		};
+
+		int _minSize;
+		double _zThresh;
+		pthread_mutex_t _lock;
+		std::vector< Chunk > _chunks;
+		std::vector< Row > _rows;
+	};
+
+} // namespace hotspot
+
+#endif /* HOTSPOT_BED_HPP_ */
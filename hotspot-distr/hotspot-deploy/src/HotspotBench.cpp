@@ -0,0 +1,739 @@
+/**
+ * File: HotspotBench.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  Entry point of hotspot-bench, which times the stages of hotspot on a
+ *  synthetic library (see SyntheticLibrary.hpp) of any depth:
+ *
+ *    read      InputDataReader, over the library as a text file
+ *    mappable  MappableCountsDataReader, building its cache from the text
+ *    sweep     ComputeHotSpots
+ *    filter    FilterHotspots
+ *    cluster   ClusterSize
+ *    hotspot   the whole of a serial hotspot run, from the files
+ *
+ *  The sweep, filter and cluster stages draw each chromosome in memory,
+ *  and time only their own stage of it.  Each stage runs in a child
+ *  process of its own, so that its peak memory is its own.  Stages are
+ *  run a few times, and the fastest run is kept.
+ *
+ *  Results can be recorded in a baselines file, by stage and library
+ *  depth, and later runs compared against it.  A stage that has slowed
+ *  down, or grown in peak memory, by more than the tolerance is reported
+ *  as a regression; with -gate, hotspot-bench then exits with an error.
+ *  Stages that take only a few milliseconds are compared but not judged.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ByLine.hpp"
+#include "Cluster.hpp"
+#include "Hotspot.hpp"
+#include "HotspotDefaults.hpp"
+#include "HotspotTable.hpp"
+#include "InputDataReader.hpp"
+#include "MappableCountsDataReader.hpp"
+#include "SyntheticLibrary.hpp"
+
+namespace hotspot
+{
+	/**
+	 * A synthetic genome, the allotment of its tags, and the files they are
+	 * written to
+	 */
+	struct SyntheticData
+	{
+		SyntheticParams params;
+		std::vector< MappableChrom > chroms;
+		std::vector< long long > numBackground;
+		std::vector< long long > numHotspots;
+		long long numTags; // exactly, with the hotspot sizes drawn
+		long long mappableBases;
+		std::string libPath;
+		std::string countsPath;
+	};
+
+	typedef bool ( *StageFunction )( const SyntheticData& data, double& seconds, long long& bytes );
+
+	struct Stage
+	{
+		const char* name;
+		StageFunction run;
+		bool usesFiles;
+	};
+
+	struct StageResult
+	{
+		double seconds;
+		long long bytes; // input read, for the stages that read files
+		double peakMb;
+	};
+
+	struct Baseline
+	{
+		double tagsPerSec;
+		double peakMb;
+	};
+
+	// Baselines by library depth and stage name
+	typedef std::map< std::pair< long long, std::string >, Baseline > BaselineMap;
+
+	// Stages quicker than this are compared, but too noisy to call a regression
+	static const double MIN_JUDGED_SECONDS = 0.01;
+
+	static double Now( )
+	{
+		struct timeval now;
+		gettimeofday( &now, NULL );
+		return now.tv_sec + now.tv_usec * 1e-6;
+	}
+
+	static long long FileSize( const std::string& fileName )
+	{
+		struct stat fileStat;
+		return ( stat( fileName.c_str( ), &fileStat ) == 0 ) ? fileStat.st_size : 0;
+	}
+
+	/**
+	 * Draw the genome of <data>, and allot its tags
+	 */
+	void SetUpSyntheticData( SyntheticData& data )
+	{
+		SyntheticGenome( data.params, data.chroms );
+		AllotSyntheticTags( data.params, data.chroms, data.numBackground, data.numHotspots );
+		data.numTags = 0;
+		data.mappableBases = 0;
+		std::vector< int > sizes;
+		for( unsigned int c = 0; c < data.chroms.size( ); c++ )
+		{
+			data.numTags += data.numBackground[c];
+			SyntheticHotspotSizes( data.params, data.chroms[c], data.numHotspots[c], sizes );
+			for( unsigned int h = 0; h < sizes.size( ); h++ )
+			{
+				data.numTags += sizes[h];
+			}
+			data.mappableBases += data.chroms[c].weight;
+		}
+	}
+
+	/**
+	 * The bins of <chrom>, as hotspot -k reads them
+	 */
+	static void MappableCounts( const MappableChrom& chrom, std::vector< int >& counts )
+	{
+		counts.resize( chrom.segments.size( ) );
+		for( unsigned int i = 0; i < chrom.segments.size( ); i++ )
+		{
+			counts[i] = chrom.segments[i].weight;
+		}
+	}
+
+	/**
+	 * A line describing the parameters of <data>, to tell whether the files
+	 * of an earlier run can be reused
+	 */
+	static std::string ParamsStamp( const SyntheticData& data )
+	{
+		const SyntheticParams& p = data.params;
+		char stamp[256];
+		std::snprintf( stamp, sizeof( stamp ), "tags=%lld chroms=%d chromsize=%d bin=%d unmappable=%g spot=%g depth=%g width=%d seed=%llu",
+				p.numTags, p.numChroms, p.chromSize, p.binSize, p.unmappable, p.spot, p.hotspotDepth,
+				p.hotspotWidth, static_cast< unsigned long long >( p.seed ) );
+		return stamp;
+	}
+
+	/**
+	 * Write the library of <data> to <dir>, as text with its .counts file, and
+	 * its mappable counts, with their binary cache.  Files written by an earlier
+	 * run with the same parameters are kept.  Returns false, after reporting
+	 * why, on error.
+	 */
+	bool WriteSyntheticData( SyntheticData& data, const std::string& dir )
+	{
+		if( mkdir( dir.c_str( ), 0777 ) != 0 && errno != EEXIST )
+		{
+			std::fprintf( stderr, "Error: unable to create %s\n", dir.c_str( ) );
+			return false;
+		}
+		std::string stampPath = dir + "/synthetic.params";
+		data.libPath = dir + "/synthetic.lib";
+		data.countsPath = dir + "/synthetic.10kb";
+		std::string stamp = ParamsStamp( data );
+		{
+			std::ifstream in( stampPath.c_str( ) );
+			ByLine line;
+			if( in >> line && line == stamp && FileSize( data.libPath ) > 0 && FileSize( data.countsPath ) > 0 )
+			{
+				std::cerr << "Using the synthetic library in " << dir << std::endl;
+				return true;
+			}
+		}
+		std::remove( stampPath.c_str( ) );
+
+		std::cerr << "Writing a synthetic library of " << data.numTags << " tags to " << dir << std::endl;
+		std::FILE* lib = std::fopen( data.libPath.c_str( ), "w" );
+		std::FILE* counts = std::fopen( data.countsPath.c_str( ), "w" );
+		if( lib == NULL || counts == NULL )
+		{
+			std::fprintf( stderr, "Error: unable to open %s\n", ( lib == NULL ? data.libPath : data.countsPath ).c_str( ) );
+			return false;
+		}
+		std::map< std::string, std::vector< int > > cache;
+		std::vector< int > tags;
+		char line[ HotspotDefaults::MAX_CHROM_NAME_LEN + 32 ];
+		for( unsigned int c = 0; c < data.chroms.size( ); c++ )
+		{
+			const MappableChrom& chrom = data.chroms[c];
+			SyntheticTags( data.params, chrom, data.numBackground[c], data.numHotspots[c], tags );
+			for( unsigned int i = 0; i < tags.size( ); i++ )
+			{
+				int n = std::snprintf( line, sizeof( line ), "%s %d\n", chrom.name.c_str( ), tags[i] );
+				std::fwrite( line, 1, n, lib );
+			}
+			std::vector< int >& bins = cache[ chrom.name ];
+			MappableCounts( chrom, bins );
+			for( unsigned int i = 0; i < bins.size( ); i++ )
+			{
+				int n = std::snprintf( line, sizeof( line ), "%s %d %d\n", chrom.name.c_str( ),
+						chrom.segments[i].start, bins[i] );
+				std::fwrite( line, 1, n, counts );
+			}
+		}
+		bool ok = ! std::ferror( lib ) && ! std::ferror( counts );
+		ok = ( std::fclose( lib ) == 0 ) && ok;
+		ok = ( std::fclose( counts ) == 0 ) && ok;
+
+		std::string tagCountPath = data.libPath + ".counts";
+		std::FILE* tagCount = std::fopen( tagCountPath.c_str( ), "w" );
+		ok = ( tagCount != NULL ) && ok;
+		if( tagCount != NULL )
+		{
+			std::fprintf( tagCount, "%lld\n", data.numTags );
+			ok = ( std::fclose( tagCount ) == 0 ) && ok;
+		}
+		ok = ok && MappableCountsDataReader::writeCache( data.countsPath, cache );
+		if( ok )
+		{
+			std::ofstream out( stampPath.c_str( ) );
+			out << stamp << std::endl;
+			ok = out.good( );
+		}
+		if( ! ok )
+		{
+			std::fprintf( stderr, "Error: unable to write the synthetic library to %s\n", dir.c_str( ) );
+		}
+		return ok;
+	}
+
+	bool ReadStage( const SyntheticData& data, double& seconds, long long& bytes )
+	{
+		double start = Now( );
+		InputDataReader reader( data.libPath );
+		std::vector< int > tags;
+		long long numTags = 0;
+		int numRead;
+		while( ( numRead = reader.readNextChrom( tags ) ) > 0 )
+		{
+			numTags += numRead;
+			tags.clear( );
+		}
+		seconds = Now( ) - start;
+		bytes = FileSize( data.libPath );
+		return numRead == 0 && numTags == data.numTags;
+	}
+
+	bool MappableStage( const SyntheticData& data, double& seconds, long long& bytes )
+	{
+		std::remove( ( data.countsPath + ".bin" ).c_str( ) );
+		double start = Now( );
+		MappableCountsDataReader reader( data.countsPath );
+		std::vector< int > counts;
+		bool ok = true;
+		for( unsigned int c = 0; c < data.chroms.size( ); c++ )
+		{
+			counts.clear( );
+			ok = ( reader.readChrom( data.chroms[c].name, counts ) == static_cast< int >( data.chroms[c].segments.size( ) ) ) && ok;
+		}
+		seconds = Now( ) - start;
+		bytes = FileSize( data.countsPath );
+		return ok;
+	}
+
+	enum ClusteringStage { SWEEP, FILTER, CLUSTER };
+
+	/**
+	 * Run the clustering stages on each chromosome of <data>, drawn in memory,
+	 * up to <last>, and time only <last>
+	 */
+	static bool RunClusteringStages( const SyntheticData& data, ClusteringStage last, double& seconds )
+	{
+		std::vector< int > tags;
+		std::vector< int > counts;
+		HotspotArena arena;
+		std::ofstream log( "/dev/null" );
+		for( unsigned int c = 0; c < data.chroms.size( ); c++ )
+		{
+			SyntheticTags( data.params, data.chroms[c], data.numBackground[c], data.numHotspots[c], tags );
+			MappableCounts( data.chroms[c], counts );
+			arena.clear( );
+
+			double start = Now( );
+			ComputeHotSpots( tags, lowInt, highInt, incInt, totaltagcount, arena.candidates );
+			if( last == SWEEP )
+			{
+				seconds += Now( ) - start;
+				continue;
+			}
+			start = Now( );
+			FilterHotspots( arena.candidates, arena.clusters );
+			if( last == FILTER )
+			{
+				seconds += Now( ) - start;
+				continue;
+			}
+			DensityWindowStats densStats;
+			start = Now( );
+			ClusterSize( tags, densityWin, arena.clusters, counts, totaltagcount, densStats, log );
+			seconds += Now( ) - start;
+		}
+		return true;
+	}
+
+	bool SweepStage( const SyntheticData& data, double& seconds, long long& bytes )
+	{
+		return RunClusteringStages( data, SWEEP, seconds );
+	}
+
+	bool FilterStage( const SyntheticData& data, double& seconds, long long& bytes )
+	{
+		return RunClusteringStages( data, FILTER, seconds );
+	}
+
+	bool ClusterSizeStage( const SyntheticData& data, double& seconds, long long& bytes )
+	{
+		return RunClusteringStages( data, CLUSTER, seconds );
+	}
+
+	/**
+	 * A serial run of hotspot over the files, with its output discarded
+	 */
+	bool HotspotStage( const SyntheticData& data, double& seconds, long long& bytes )
+	{
+		std::FILE* out = std::fopen( "/dev/null", "w" );
+		std::ofstream log( "/dev/null" );
+		if( out == NULL )
+		{
+			return false;
+		}
+		TagCounts tagCounts;
+		tagCounts.total = totaltagcount;
+		tagCounts.background = totaltagcount;
+
+		double start = Now( );
+		InputDataReader inputDataReader( data.libPath );
+		MappableCountsDataReader mappableCountsDataReader( data.countsPath );
+		HotspotArena arena;
+		std::vector< int > tags;
+		std::vector< int > counts;
+		Hotspot::printHeader( out );
+		int numRead;
+		while( ( numRead = inputDataReader.readNextChrom( tags ) ) > 0 )
+		{
+			if( mappableCountsDataReader.readChrom( inputDataReader.currentChromName( ), counts ) < 0 )
+			{
+				break;
+			}
+			ProcessChrom( inputDataReader.currentChromName( ), tags, counts, tagCounts, arena, out, log );
+			tags.clear( );
+			counts.clear( );
+		}
+		seconds = Now( ) - start;
+		bytes = FileSize( data.libPath );
+		std::fclose( out );
+		return numRead == 0;
+	}
+
+	static const Stage STAGES[] =
+	{
+		{ "read", ReadStage, true },
+		{ "mappable", MappableStage, true },
+		{ "sweep", SweepStage, false },
+		{ "filter", FilterStage, false },
+		{ "cluster", ClusterSizeStage, false },
+		{ "hotspot", HotspotStage, true }
+	};
+	static const int NUM_STAGES = sizeof( STAGES ) / sizeof( STAGES[0] );
+
+	/**
+	 * Run <stage> in a child process, and fill in <result> with its time and
+	 * the child's peak resident memory.  Returns false if the stage failed.
+	 */
+	bool RunStage( const Stage& stage, const SyntheticData& data, StageResult& result )
+	{
+		int fds[2];
+		if( pipe( fds ) != 0 )
+		{
+			return false;
+		}
+		std::fflush( NULL );
+		pid_t pid = fork( );
+		if( pid < 0 )
+		{
+			close( fds[0] );
+			close( fds[1] );
+			return false;
+		}
+		if( pid == 0 )
+		{
+			close( fds[0] );
+			double seconds = 0.0;
+			long long bytes = 0;
+			bool ok = stage.run( data, seconds, bytes );
+			char report[64];
+			int n = std::snprintf( report, sizeof( report ), "%.6f %lld", seconds, bytes );
+			ok = ( write( fds[1], report, n ) == n ) && ok;
+			_exit( ok ? EXIT_SUCCESS : EXIT_FAILURE );
+		}
+
+		close( fds[1] );
+		std::string report;
+		char buffer[64];
+		ssize_t n;
+		while( ( n = read( fds[0], buffer, sizeof( buffer ) ) ) > 0 )
+		{
+			report.append( buffer, n );
+		}
+		close( fds[0] );
+		int status;
+		struct rusage usage;
+		if( wait4( pid, &status, 0, &usage ) != pid || ! WIFEXITED( status ) || WEXITSTATUS( status ) != EXIT_SUCCESS )
+		{
+			return false;
+		}
+		result.peakMb = usage.ru_maxrss / 1024.0; // kilobytes
+		return std::sscanf( report.c_str( ), "%lf %lld", &result.seconds, &result.bytes ) == 2;
+	}
+
+	/**
+	 * Read the baselines of <fileName> into <baselines>.  A missing file has
+	 * none.  Returns false, after reporting why, on a malformed file.
+	 */
+	bool ReadBaselines( const std::string& fileName, BaselineMap& baselines )
+	{
+		std::ifstream in( fileName.c_str( ) );
+		char stageName[64];
+		long long numTags;
+		Baseline baseline;
+		int lineNum = 0;
+		ByLine line;
+		while( in >> line )
+		{
+			lineNum++;
+			if( line.empty( ) || line[0] == '#' )
+			{
+				continue;
+			}
+			if( std::sscanf( line.c_str( ), "%63s %lld %lf %lf", stageName, &numTags,
+							 &baseline.tagsPerSec, &baseline.peakMb ) != 4 )
+			{
+				std::fprintf( stderr, "Error: input file %s contains a malformed entry on line %d\n",
+						fileName.c_str( ), lineNum );
+				return false;
+			}
+			baselines[ std::make_pair( numTags, std::string( stageName ) ) ] = baseline;
+		}
+		return true;
+	}
+
+	/**
+	 * Write <baselines> to <fileName>.  Returns false, after reporting why, on
+	 * error.
+	 */
+	bool WriteBaselines( const std::string& fileName, const BaselineMap& baselines )
+	{
+		std::FILE* fp = std::fopen( fileName.c_str( ), "w" );
+		if( fp == NULL )
+		{
+			std::fprintf( stderr, "Error: unable to open %s\n", fileName.c_str( ) );
+			return false;
+		}
+		std::fprintf( fp, "# hotspot-bench baselines, written by make bench-baseline\n" );
+		std::fprintf( fp, "# <stage> <library tags> <tags/sec> <peak resident MB>\n" );
+		for( BaselineMap::const_iterator i = baselines.begin( ); i != baselines.end( ); ++i )
+		{
+			std::fprintf( fp, "%s %lld %.0f %.1f\n", i->first.second.c_str( ), i->first.first,
+					i->second.tagsPerSec, i->second.peakMb );
+		}
+		if( std::fclose( fp ) != 0 )
+		{
+			std::fprintf( stderr, "Error: unable to write %s\n", fileName.c_str( ) );
+			return false;
+		}
+		return true;
+	}
+}
+
+int main( int argc, char **argv )
+{
+	hotspot::SyntheticData data;
+	hotspot::SyntheticParams& params = data.params;
+	params.numTags = hotspot::HotspotDefaults::BENCH_TAGS;
+	params.numChroms = hotspot::HotspotDefaults::BENCH_CHROMS;
+	params.chromSize = hotspot::HotspotDefaults::BENCH_CHROM_SIZE;
+	params.binSize = hotspot::HotspotDefaults::DENSITY_WIN_SMALL;
+	params.unmappable = hotspot::HotspotDefaults::BENCH_UNMAPPABLE;
+	params.spot = hotspot::HotspotDefaults::BENCH_SPOT;
+	params.hotspotDepth = hotspot::HotspotDefaults::BENCH_HOTSPOT_DEPTH;
+	params.hotspotWidth = hotspot::HotspotDefaults::BENCH_HOTSPOT_WIDTH;
+	params.seed = hotspot::HotspotDefaults::BENCH_SEED;
+	hotspot::numSD = hotspot::HotspotDefaults::MINSD;
+	hotspot::lowInt = hotspot::HotspotDefaults::LOW_INTERVAL_WIDTH;
+	hotspot::highInt = hotspot::HotspotDefaults::HIGH_INTEVAL_WIDTH;
+	hotspot::incInt = hotspot::HotspotDefaults::INTERVAL_INCREMENT;
+	hotspot::densityWin = hotspot::HotspotDefaults::DENSITY_WIN;
+
+	std::string dir, baselinePath, recordPath, stageList;
+	double tolerance = hotspot::HotspotDefaults::BENCH_TOLERANCE;
+	int repeat = 3;
+	bool generateOnly = false;
+	bool gate = false;
+	for( int i = 1; i < argc; i++ )
+	{
+		bool hasValue = ( i + 1 < argc );
+		if( std::strcmp( argv[ i ], "-dir" ) == 0 && hasValue )
+		{
+			dir = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-tags" ) == 0 && hasValue )
+		{
+			params.numTags = std::atoll( argv[ ++i ] );
+		}
+		else if( std::strcmp( argv[ i ], "-chroms" ) == 0 && hasValue )
+		{
+			params.numChroms = std::atoi( argv[ ++i ] );
+		}
+		else if( std::strcmp( argv[ i ], "-chromsize" ) == 0 && hasValue )
+		{
+			params.chromSize = std::atoi( argv[ ++i ] );
+		}
+		else if( std::strcmp( argv[ i ], "-spot" ) == 0 && hasValue )
+		{
+			params.spot = std::atof( argv[ ++i ] );
+		}
+		else if( std::strcmp( argv[ i ], "-depth" ) == 0 && hasValue )
+		{
+			params.hotspotDepth = std::atof( argv[ ++i ] );
+		}
+		else if( std::strcmp( argv[ i ], "-seed" ) == 0 && hasValue )
+		{
+			params.seed = std::strtoull( argv[ ++i ], NULL, 10 );
+		}
+		else if( std::strcmp( argv[ i ], "-range" ) == 0 && i + 3 < argc )
+		{
+			hotspot::lowInt = std::atoi( argv[ ++i ] );
+			hotspot::highInt = std::atoi( argv[ ++i ] );
+			hotspot::incInt = std::atoi( argv[ ++i ] );
+		}
+		else if( std::strcmp( argv[ i ], "-densWin" ) == 0 && hasValue )
+		{
+			hotspot::densityWin = std::atoi( argv[ ++i ] );
+		}
+		else if( std::strcmp( argv[ i ], "-stages" ) == 0 && hasValue )
+		{
+			stageList = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-repeat" ) == 0 && hasValue )
+		{
+			repeat = std::atoi( argv[ ++i ] );
+		}
+		else if( std::strcmp( argv[ i ], "-baseline" ) == 0 && hasValue )
+		{
+			baselinePath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-record" ) == 0 && hasValue )
+		{
+			recordPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-tolerance" ) == 0 && hasValue )
+		{
+			tolerance = std::atof( argv[ ++i ] );
+		}
+		else if( std::strcmp( argv[ i ], "-gate" ) == 0 )
+		{
+			gate = true;
+		}
+		else if( std::strcmp( argv[ i ], "-generate" ) == 0 )
+		{
+			generateOnly = true;
+		}
+		else
+		{
+			std::cerr << "Unrecognized option: " << argv[ i ] << ". Aborting." << std::endl;
+			std::exit( EXIT_FAILURE );
+		}
+	}
+
+	// The chosen stages, in the order of STAGES
+	std::vector< int > stages;
+	for( int s = 0; s < hotspot::NUM_STAGES; s++ )
+	{
+		std::string name = hotspot::STAGES[s].name;
+		if( stageList.empty( ) || ( "," + stageList + "," ).find( "," + name + "," ) != std::string::npos )
+		{
+			stages.push_back( s );
+		}
+	}
+	bool needFiles = generateOnly;
+	for( unsigned int s = 0; s < stages.size( ); s++ )
+	{
+		needFiles = needFiles || hotspot::STAGES[ stages[s] ].usesFiles;
+	}
+	if( stages.empty( ) || ( needFiles && dir.empty( ) ) || params.numTags <= 0 || params.numChroms <= 0
+		|| params.chromSize <= 0 || repeat <= 0 )
+	{
+		std::string msg  = "Usage: hotspot-bench -dir <directory> [options]";
+		msg += "\n    -dir <directory> (where the synthetic library and mappable counts are written, and kept for later runs)";
+		msg += "\n    -tags <int> (tags in the synthetic library - default=1000000)";
+		msg += "\n    -chroms <int> (number of chromosomes - default=20)";
+		msg += "\n    -chromsize <int> (bases in each chromosome - default=125000000)";
+		msg += "\n    -spot <float> (share of the tags in planted hotspots - default=0.2)";
+		msg += "\n    -depth <float> (mean tags per planted hotspot - default=40)";
+		msg += "\n    -seed <int> (seed for the synthetic library - default=1)";
+		msg += "\n    -range <int> <int> <int> (lower upper increment windows, as for hotspot)";
+		msg += "\n    -densWin <int> (background window, as for hotspot)";
+		msg += "\n    -stages <list> (comma-separated, of read, mappable, sweep, filter, cluster and hotspot - default=all)";
+		msg += "\n    -repeat <int> (runs of each stage, of which the fastest is kept - default=3)";
+		msg += "\n    -baseline <file-name> (compare with the baselines in this file)";
+		msg += "\n    -record <file-name> (record the results as baselines in this file, replacing any for the same stages and depth)";
+		msg += "\n    -tolerance <float> (slowdown, or growth in peak memory, reported as a regression - default=0.25)";
+		msg += "\n    -gate (exit with an error if any stage is a regression)";
+		msg += "\n    -generate (only write the synthetic library and mappable counts to -dir)";
+		msg += "\n";
+		std::cerr << msg << std::endl;
+		std::exit( EXIT_FAILURE );
+	}
+
+	hotspot::SetUpSyntheticData( data );
+	if( data.numTags > INT_MAX )
+	{
+		std::fprintf( stderr, "Error: hotspot counts at most %d tags; the synthetic library has %lld\n", INT_MAX, data.numTags );
+		std::exit( EXIT_FAILURE );
+	}
+	hotspot::totaltagcount = data.numTags;
+	hotspot::genomeSize = data.mappableBases;
+	if( needFiles && ! hotspot::WriteSyntheticData( data, dir ) )
+	{
+		std::exit( EXIT_FAILURE );
+	}
+	if( generateOnly )
+	{
+		std::cout << data.libPath << "\t" << data.numTags << " tags" << std::endl;
+		std::cout << data.countsPath << "\t" << data.mappableBases << " mappable bases" << std::endl;
+		std::exit( EXIT_SUCCESS );
+	}
+
+	hotspot::BaselineMap baselines;
+	if( ! baselinePath.empty( ) && ! hotspot::ReadBaselines( baselinePath, baselines ) )
+	{
+		std::exit( EXIT_FAILURE );
+	}
+	hotspot::BaselineMap recorded;
+	if( ! recordPath.empty( ) && ! hotspot::ReadBaselines( recordPath, recorded ) )
+	{
+		std::exit( EXIT_FAILURE );
+	}
+
+	std::printf( "%-9s %11s %9s %12s %9s %9s  %s\n", "stage", "tags", "seconds", "tags/sec", "MB/sec", "peak MB",
+			baselinePath.empty( ) ? "" : "vs. baseline" );
+	bool ok = true;
+	for( unsigned int s = 0; s < stages.size( ); s++ )
+	{
+		const hotspot::Stage& stage = hotspot::STAGES[ stages[s] ];
+		hotspot::StageResult best;
+		bool ran = false;
+		for( int r = 0; r < repeat; r++ )
+		{
+			hotspot::StageResult result;
+			if( ! hotspot::RunStage( stage, data, result ) )
+			{
+				break;
+			}
+			if( ! ran || result.seconds < best.seconds )
+			{
+				best = result;
+			}
+			ran = true;
+		}
+		if( ! ran )
+		{
+			std::fprintf( stderr, "Error: the %s stage failed\n", stage.name );
+			ok = false;
+			continue;
+		}
+
+		double seconds = std::max( best.seconds, 1e-6 );
+		hotspot::Baseline measured;
+		measured.tagsPerSec = data.numTags / seconds;
+		measured.peakMb = best.peakMb;
+		char throughput[32] = "-";
+		if( best.bytes > 0 )
+		{
+			std::snprintf( throughput, sizeof( throughput ), "%.1f", best.bytes / seconds / ( 1 << 20 ) );
+		}
+		std::string comparison;
+		hotspot::BaselineMap::const_iterator b = baselines.find( std::make_pair( data.numTags, std::string( stage.name ) ) );
+		if( b != baselines.end( ) )
+		{
+			double speed = measured.tagsPerSec / b->second.tagsPerSec - 1.0;
+			double memory = measured.peakMb / b->second.peakMb - 1.0;
+			char text[96];
+			std::snprintf( text, sizeof( text ), "speed %+.0f%%, memory %+.0f%%", 100.0 * speed, 100.0 * memory );
+			comparison = text;
+			if( best.seconds < hotspot::MIN_JUDGED_SECONDS )
+			{
+				comparison += "  (too quick to judge)";
+			}
+			else if( measured.tagsPerSec < b->second.tagsPerSec * ( 1.0 - tolerance )
+					 || measured.peakMb > b->second.peakMb * ( 1.0 + tolerance ) )
+			{
+				comparison += "  REGRESSION";
+				ok = ok && ! gate;
+			}
+		}
+		else if( ! baselinePath.empty( ) )
+		{
+			comparison = "no baseline";
+		}
+		std::printf( "%-9s %11lld %9.3f %12.0f %9s %9.1f  %s\n", stage.name, data.numTags, best.seconds,
+				measured.tagsPerSec, throughput, measured.peakMb, comparison.c_str( ) );
+		std::fflush( stdout );
+		recorded[ std::make_pair( data.numTags, std::string( stage.name ) ) ] = measured;
+	}
+
+	if( ! recordPath.empty( ) && ! hotspot::WriteBaselines( recordPath, recorded ) )
+	{
+		std::exit( EXIT_FAILURE );
+	}
+	std::exit( ok ? EXIT_SUCCESS : EXIT_FAILURE );
+}
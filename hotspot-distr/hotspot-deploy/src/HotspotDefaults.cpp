@@ -15,6 +15,13 @@ namespace hotspot
 {
 	const float HotspotDefaults::MAPPABLE_GENOME_SIZE = 2.55E9;
 	const float HotspotDefaults::MINSD = 3.0;
+	const float HotspotDefaults::PASS2_Z_THRESH = 2.0;
+	const float HotspotDefaults::FDR_Z_MIN = 3.0;
+	const float HotspotDefaults::FDR_Z_MAX = 35.0;
+	const double HotspotDefaults::BADSPOT_THRESH = 0.8;
+	const double HotspotDefaults::BENCH_SPOT = 0.2;
+	const double HotspotDefaults::BENCH_UNMAPPABLE = 0.05;
+	const double HotspotDefaults::BENCH_TOLERANCE = 0.25;
 	const char *HotspotDefaults::LIB_PATH = "input.lib";
 	const char *HotspotDefaults::DENSITY_PATH = "mappable_site.counts";
 }
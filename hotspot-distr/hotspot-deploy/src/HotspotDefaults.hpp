@@ -21,8 +21,10 @@ namespace hotspot
 		// Behavior
 		static const bool USE_DEFAULT_BACKGROUND_TAGS = true;
 		static const bool USE_GENOME_DENS_WIN = false;
-		static const bool USE_FUZZY_THRESHOLD = false;
-		static const int FUZZY_SEED = 1;
+		static const int RANDOM_LIB_SEED = 1; // hotspot-randlib -seed
+		static const int NUM_THREADS = 1;
+		static const int MIN_TAGS_PARALLEL_SWEEP = 100000; // smaller chromosomes sweep all window sizes on one thread
+		static const int STREAM_CHUNK_TAGS = 1 << 16; // tags read at a time from a pipe
 
 		// Windowing
 		static const float MINSD;
@@ -32,6 +34,38 @@ namespace hotspot
 		static const int DENSITY_WIN_SMALL = 10000;
 		static const int DENSITY_WIN = 50000;
 
+		// Two-pass mode: pass-1 hotspots that pass 2 is built around
+		static const int PASS2_MIN_SIZE = 10;
+		static const float PASS2_Z_THRESH;
+		static const int PASS2_MERGE_DIST = 150;
+
+		// FDR thresholds: the range searched for a threshold z-score
+		static const float FDR_Z_MIN;
+		static const float FDR_Z_MAX;
+
+		// Badspots: small windows holding most of the tags around them
+		static const int BADSPOT_MIN_TAGS = 5;
+		static const double BADSPOT_THRESH; // a double, so that 8 tags of 10 reach .8
+		static const int BADSPOT_STEP = 50;
+		static const int BADSPOT_WIN_SMALL = 50;
+		static const int BADSPOT_WIN_LARGE = 250;
+
+		// Peak-finding: the tag density track that is smoothed for peaks
+		static const int PEAK_DENSITY_WIN = 150;
+		static const int PEAK_DENSITY_STEP = 20;
+		static const int PEAK_SMOOTH_LEVEL = 3;
+
+		// Benchmarks: the synthetic genome and library of hotspot-bench
+		static const int BENCH_TAGS = 1000000;
+		static const int BENCH_CHROMS = 20;
+		static const int BENCH_CHROM_SIZE = 125000000;
+		static const double BENCH_SPOT;       // share of the tags in planted hotspots
+		static const int BENCH_HOTSPOT_DEPTH = 40; // mean tags per planted hotspot
+		static const int BENCH_HOTSPOT_WIDTH = 150;
+		static const int BENCH_SEED = 1;
+		static const double BENCH_UNMAPPABLE; // share of bins with nothing mappable
+		static const double BENCH_TOLERANCE;  // slowdown, or growth in peak memory, that is a regression
+
 		// Input
 		static const char *LIB_PATH;
 		static const char *DENSITY_PATH;
@@ -40,6 +74,7 @@ namespace hotspot
 		static const int MAXLINE = 100000;
 		static const float MAPPABLE_GENOME_SIZE;
 		static const int MAX_CHROM_NAME_LEN = 127;
+		static const int INPUT_BUFFER_SIZE = 1 << 22; // bytes read at a time from unmappable input
 	};
 
 } // namespace
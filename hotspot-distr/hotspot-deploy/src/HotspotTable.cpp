@@ -0,0 +1,139 @@
+/**
+ * File: HotspotTable.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  An implementation of HotspotTable.hpp
+ */
+
+#include "HotspotTable.hpp"
+#include <algorithm>
+
+#include "Hotspot.hpp"
+
+namespace hotspot
+{
+
+	int HotspotTable::appendCandidate( int tag )
+	{
+		static const Hotspot defaults;
+		tagIndex.push_back( tag );
+		averagePos.push_back( defaults.averagePos );
+		maxWindow.push_back( defaults.maxWindow );
+		weightedAvgSD.push_back( defaults.weightedAvgSD );
+		densCount.push_back( defaults.densCount );
+		return averagePos.size( ) - 1;
+	}
+
+	int HotspotTable::appendCluster( )
+	{
+		static const Hotspot defaults;
+		int row = appendCandidate( -1 );
+		filterDist.push_back( defaults.filterDist );
+		filterIndexLeft.push_back( defaults.filterIndexLeft );
+		filterIndexRight.push_back( defaults.filterIndexRight );
+		filterDensIndexLeft.push_back( defaults.filterDensIndexLeft );
+		filterDensIndexRight.push_back( defaults.filterDensIndexRight );
+		filterSize.push_back( defaults.filterSize );
+		filterWidth.push_back( defaults.filterWidth );
+		minSite.push_back( defaults.minSite );
+		maxSite.push_back( defaults.maxSite );
+		filteredZScore.push_back( defaults.filteredZScore );
+		filteredZScoreAdjusted.push_back( defaults.filteredZScoreAdjusted );
+		pValue.push_back( defaults.pValue );
+		pValueGenome.push_back( defaults.pValueGenome );
+		spannedBases.push_back( defaults.spannedBases );
+		densTags.push_back( defaults.densTags );
+		mappableSites.push_back( defaults.mappableSites );
+		return row;
+	}
+
+	template< typename T >
+	static void eraseFront( std::vector< T >& column, int n )
+	{
+		column.erase( column.begin( ), column.begin( ) + std::min( n, static_cast< int >( column.size( ) ) ) );
+	}
+
+	void HotspotTable::clear( )
+	{
+		tagIndex.clear( );
+		averagePos.clear( );
+		maxWindow.clear( );
+		weightedAvgSD.clear( );
+		densCount.clear( );
+		filterDist.clear( );
+		filterIndexLeft.clear( );
+		filterIndexRight.clear( );
+		filterDensIndexLeft.clear( );
+		filterDensIndexRight.clear( );
+		filterSize.clear( );
+		filterWidth.clear( );
+		minSite.clear( );
+		maxSite.clear( );
+		filteredZScore.clear( );
+		filteredZScoreAdjusted.clear( );
+		pValue.clear( );
+		pValueGenome.clear( );
+		spannedBases.clear( );
+		densTags.clear( );
+		mappableSites.clear( );
+	}
+
+	void HotspotTable::eraseFront( int n )
+	{
+		hotspot::eraseFront( tagIndex, n );
+		hotspot::eraseFront( averagePos, n );
+		hotspot::eraseFront( maxWindow, n );
+		hotspot::eraseFront( weightedAvgSD, n );
+		hotspot::eraseFront( densCount, n );
+		hotspot::eraseFront( filterDist, n );
+		hotspot::eraseFront( filterIndexLeft, n );
+		hotspot::eraseFront( filterIndexRight, n );
+		hotspot::eraseFront( filterDensIndexLeft, n );
+		hotspot::eraseFront( filterDensIndexRight, n );
+		hotspot::eraseFront( filterSize, n );
+		hotspot::eraseFront( filterWidth, n );
+		hotspot::eraseFront( minSite, n );
+		hotspot::eraseFront( maxSite, n );
+		hotspot::eraseFront( filteredZScore, n );
+		hotspot::eraseFront( filteredZScoreAdjusted, n );
+		hotspot::eraseFront( pValue, n );
+		hotspot::eraseFront( pValueGenome, n );
+		hotspot::eraseFront( spannedBases, n );
+		hotspot::eraseFront( densTags, n );
+		hotspot::eraseFront( mappableSites, n );
+	}
+
+	template< typename T >
+	static long long columnBytes( const std::vector< T >& column )
+	{
+		return static_cast< long long >( column.capacity( ) ) * sizeof( T );
+	}
+
+	long long HotspotTable::bytes( ) const
+	{
+		return columnBytes( tagIndex )
+			+ columnBytes( averagePos )
+			+ columnBytes( maxWindow )
+			+ columnBytes( weightedAvgSD )
+			+ columnBytes( densCount )
+			+ columnBytes( filterDist )
+			+ columnBytes( filterIndexLeft )
+			+ columnBytes( filterIndexRight )
+			+ columnBytes( filterDensIndexLeft )
+			+ columnBytes( filterDensIndexRight )
+			+ columnBytes( filterSize )
+			+ columnBytes( filterWidth )
+			+ columnBytes( minSite )
+			+ columnBytes( maxSite )
+			+ columnBytes( filteredZScore )
+			+ columnBytes( filteredZScoreAdjusted )
+			+ columnBytes( pValue )
+			+ columnBytes( pValueGenome )
+			+ columnBytes( spannedBases )
+			+ columnBytes( densTags )
+			+ columnBytes( mappableSites );
+	}
+}
@@ -0,0 +1,113 @@
+/**
+ * File: HotspotTable.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *   Column-wise storage for the hotspots of one chromosome: one vector
+ *   per Hotspot field, with rows in index order.  Rows are appended
+ *   rather than allocated one by one, and clear( ) keeps the storage,
+ *   so a table can be reused from chromosome to chromosome.
+ */
+
+#ifndef HOTSPOT_TABLE_HPP_
+#define HOTSPOT_TABLE_HPP_
+
+#include <vector>
+
+#include "Hotspot.hpp"
+#include "OutputBuffer.hpp"
+
+namespace hotspot
+{
+
+	class HotspotTable
+	{
+	public:
+		// Detection columns: the only ones filled for candidate rows
+		std::vector< int > tagIndex;
+		std::vector< int > averagePos;
+		std::vector< int > maxWindow;
+		std::vector< double > weightedAvgSD;
+		std::vector< double > densCount;
+
+		// Cluster columns: filled for filtered rows only
+		std::vector< int > filterDist;
+		std::vector< int > filterIndexLeft;
+		std::vector< int > filterIndexRight;
+		std::vector< int > filterDensIndexLeft;
+		std::vector< int > filterDensIndexRight;
+		std::vector< int > filterSize;
+		std::vector< double > filterWidth;
+		std::vector< int > minSite;
+		std::vector< int > maxSite;
+		std::vector< double > filteredZScore;
+		std::vector< double > filteredZScoreAdjusted;
+		std::vector< double > pValue;
+		std::vector< double > pValueGenome;
+
+		// Scoring columns: what ScoreCluster counts for each filtered row,
+		// for the z-scores and p-values to be computed a batch at a time
+		std::vector< int > spannedBases;
+		std::vector< int > densTags;
+		std::vector< int > mappableSites;
+
+		/**
+		 * Number of rows
+		 */
+		int size( ) const { return averagePos.size( ); }
+
+		/**
+		 * Append a candidate row for tag <tag>, with Hotspot default values
+		 * in the detection columns.  Returns the new row number.
+		 */
+		int appendCandidate( int tag );
+
+		/**
+		 * Append a row with Hotspot default values in every column.  Returns
+		 * the new row number.
+		 */
+		int appendCluster( );
+
+		/**
+		 * Remove all rows, keeping the allocated storage for reuse
+		 */
+		void clear( );
+
+		/**
+		 * Remove the first <n> rows; later rows move down by <n>
+		 */
+		void eraseFront( int n );
+
+		/**
+		 * Bytes allocated for the columns, in use or kept for reuse
+		 */
+		long long bytes( ) const;
+	};
+
+	/**
+	 * Per-chromosome working storage for the clustering stages
+	 */
+	struct HotspotArena
+	{
+		HotspotTable candidates; // ComputeHotSpots output
+		HotspotTable clusters;   // FilterHotspots and ClusterSize output
+		OutputBuffer output;     // the clusters, as written
+
+		void clear( )
+		{
+			candidates.clear( );
+			clusters.clear( );
+			output.clear( );
+		}
+
+		long long bytes( ) const
+		{
+			return candidates.bytes( ) + clusters.bytes( ) + output.capacity( );
+		}
+	};
+
+} // namespace hotspot
+
+#endif /* HOTSPOT_TABLE_HPP_ */
@@ -10,103 +10,423 @@
 
 #include "InputDataReader.hpp"
 #include "HotspotDefaults.hpp"
-#include "ByLine.hpp"
 
 #include <string>
+#include <cerrno>
+#include <climits>
 #include <cstdio>
-#include <istream>
-#include <exception>
+#include <cstring>
 #include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 namespace hotspot
 {
 
 	InputDataReader::InputDataReader( const std::string& inputFileName )
-					: _inputFileName( inputFileName ), _currentChromName( "" )
+					: _inputFileName( inputFileName ), _fd( -1 ), _currentChromName( "" )
+					, _map( NULL ), _mapSize( 0 ), _cursor( NULL ), _end( NULL ), _eof( false )
+					, _binary( false ), _binaryCorrupt( false ), _binaryTotalTags( 0 ), _nextBinaryChrom( 0 )
 					, _nextTag( -1 ), _nextChromName( "" ), _hasMoreData( false ),
-					_numChromsProcessed( 0 )
+					_numChromsProcessed( 0 ), _inChrom( false ), _chromLines( 0 ),
+					_bytesParsed( 0 ), _linesParsed( 0 ), _regularFile( false )
 
 	{
-		_inputDataStream.open( _inputFileName.c_str( ) );
+		if( _inputFileName == "-" )
+		{
+			_fd = dup( STDIN_FILENO );
+		}
+		else
+		{
+			_fd = open( _inputFileName.c_str( ), O_RDONLY );
+		}
+		if( _fd < 0 )
+		{
+			_eof = true;
+			return;
+		}
+
+		struct stat st;
+		_regularFile = ( fstat( _fd, &st ) == 0 && S_ISREG( st.st_mode ) );
+		if( _regularFile && st.st_size > 0 )
+		{
+			void* map = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, _fd, 0 );
+			if( map != MAP_FAILED )
+			{
+				madvise( map, st.st_size, MADV_SEQUENTIAL );
+				madvise( map, st.st_size, MADV_WILLNEED );
+				_map = static_cast< const char* >( map );
+				_mapSize = st.st_size;
+				_cursor = _map;
+				_end = _map + _mapSize;
+				_eof = true; // nothing more to fetch
+
+				if( BinaryTagLibrary::isBinary( _map, _mapSize ) )
+				{
+					_binary = true;
+					if( ! BinaryTagLibrary::readIndex( _map, _mapSize, _binaryTotalTags, _binaryChroms ) )
+					{
+						std::fprintf( stderr, "Error: input file %s is a malformed binary tag library\n", _inputFileName.c_str( ) );
+						_binaryCorrupt = true;
+					}
+				}
+			}
+		}
 	}
 
 	InputDataReader::~InputDataReader()
 	{
-		if( _inputDataStream )
+		if( _map != NULL )
+		{
+			munmap( const_cast< char* >( _map ), _mapSize );
+		}
+		if( _fd >= 0 )
 		{
-			_inputDataStream.close( );
+			close( _fd );
 		}
 	}
 
 	int InputDataReader::numLines( ) const
 	{
-		std::ifstream inf;
-		inf.open( _inputFileName.c_str( ) );
-
 		int numLines = 0;
-		ByLine inputDataRecord;
-		while( inf >> inputDataRecord ) numLines++;
-		inf.close( );
+		if( _binary )
+		{
+			return _binaryCorrupt ? 0 : _binaryTotalTags;
+		}
+		if( _map != NULL )
+		{
+			const char* p = _map;
+			const char* end = _map + _mapSize;
+			while( ( p = static_cast< const char* >( std::memchr( p, '\n', end - p ) ) ) != NULL )
+			{
+				numLines++;
+				p++;
+			}
+			if( _map[ _mapSize - 1 ] != '\n' )
+			{
+				numLines++; // last line has no newline
+			}
+			return numLines;
+		}
+
+		int fd = open( _inputFileName.c_str( ), O_RDONLY );
+		if( fd < 0 )
+		{
+			return 0;
+		}
+		std::vector< char > buf( HotspotDefaults::INPUT_BUFFER_SIZE );
+		char last = '\n';
+		ssize_t n;
+		while( ( n = read( fd, &buf[0], buf.size( ) ) ) > 0 )
+		{
+			const char* p = &buf[0];
+			const char* end = p + n;
+			while( ( p = static_cast< const char* >( std::memchr( p, '\n', end - p ) ) ) != NULL )
+			{
+				numLines++;
+				p++;
+			}
+			last = buf[ n - 1 ];
+		}
+		if( last != '\n' )
+		{
+			numLines++;
+		}
+		close( fd );
 		return numLines;
 	}
 
+	bool InputDataReader::tagCount( int& count ) const
+	{
+		if( _binary )
+		{
+			if( _binaryCorrupt )
+			{
+				return false;
+			}
+			count = _binaryTotalTags;
+			return true;
+		}
+
+		std::string countsFileName = _inputFileName + ".counts";
+		struct stat libStat;
+		struct stat countsStat;
+		if( stat( _inputFileName.c_str( ), &libStat ) != 0
+			|| stat( countsFileName.c_str( ), &countsStat ) != 0
+			|| countsStat.st_mtime < libStat.st_mtime )
+		{
+			return false;
+		}
+
+		std::FILE* fp = std::fopen( countsFileName.c_str( ), "r" );
+		if( fp == NULL )
+		{
+			return false;
+		}
+		int value = -1;
+		bool found = ( std::fscanf( fp, "%d", &value ) == 1 && value >= 0 );
+		std::fclose( fp );
+		if( found )
+		{
+			count = value;
+		}
+		return found;
+	}
+
+	int InputDataReader::readChrom( const std::string& chromName, std::vector< int >& tags ) const
+	{
+		if( ! _binary || _binaryCorrupt )
+		{
+			return -1;
+		}
+		for( unsigned int i = 0; i < _binaryChroms.size( ); i++ )
+		{
+			const BinaryTagLibrary::Chrom& chrom = _binaryChroms[i];
+			if( chrom.name == chromName )
+			{
+				if( ! BinaryTagLibrary::decodeTags( _map, chrom, tags ) )
+				{
+					std::fprintf( stderr, "Error: input file %s contains a malformed entry for %s\n", _inputFileName.c_str( ), chrom.name.c_str( ) );
+					return -1;
+				}
+				return chrom.numTags;
+			}
+		}
+		return -1;
+	}
+
+	long long InputDataReader::bytesParsed( ) const
+	{
+		return _bytesParsed;
+	}
+
+	long long InputDataReader::linesParsed( ) const
+	{
+		return _linesParsed;
+	}
+
+	bool InputDataReader::isRegularFile( ) const
+	{
+		return _regularFile;
+	}
+
 	std::string InputDataReader::currentChromName( ) const
 	{
 		return _currentChromName;
 	}
 
+	bool InputDataReader::fillBuffer( )
+	{
+		if( _eof )
+		{
+			return false;
+		}
+
+		// Keep the unread tail, and make room for at least a buffer's worth more
+		std::size_t keep = _end - _cursor;
+		if( _buffer.empty( ) )
+		{
+			_buffer.resize( HotspotDefaults::INPUT_BUFFER_SIZE );
+		}
+		else if( keep > 0 )
+		{
+			std::memmove( &_buffer[0], _cursor, keep );
+		}
+		if( _buffer.size( ) - keep < static_cast< std::size_t >( HotspotDefaults::INPUT_BUFFER_SIZE ) / 2 )
+		{
+			_buffer.resize( _buffer.size( ) * 2 ); // a line longer than the buffer
+		}
+
+		ssize_t n;
+		do
+		{
+			n = read( _fd, &_buffer[ keep ], _buffer.size( ) - keep );
+		} while( n < 0 && errno == EINTR );
+		if( n <= 0 )
+		{
+			_eof = true;
+			n = 0;
+		}
+		_cursor = &_buffer[0];
+		_end = _cursor + keep + n;
+		return n > 0;
+	}
+
+	bool InputDataReader::nextLine( const char*& line, const char*& lineEnd )
+	{
+		while( true )
+		{
+			if( _cursor != NULL && _cursor < _end )
+			{
+				const char* eol = static_cast< const char* >( std::memchr( _cursor, '\n', _end - _cursor ) );
+				if( eol != NULL )
+				{
+					line = _cursor;
+					lineEnd = eol;
+					_cursor = eol + 1;
+					_bytesParsed += _cursor - line;
+					_linesParsed++;
+					return true;
+				}
+			}
+			if( ! fillBuffer( ) )
+			{
+				break;
+			}
+		}
+
+		// A last line without a newline
+		if( _cursor != NULL && _cursor < _end )
+		{
+			line = _cursor;
+			lineEnd = _end;
+			_cursor = _end;
+			_bytesParsed += lineEnd - line;
+			_linesParsed++;
+			return true;
+		}
+		return false;
+	}
+
+	bool InputDataReader::parseRecord( const char* p, const char* end,
+									   const char*& name, std::size_t& nameLen, int& tagLoc )
+	{
+		// Whitespace, as skipped by scanf
+		#define HOTSPOT_IS_SPACE( c ) ( (c) == ' ' || ( (c) >= '\t' && (c) <= '\r' ) )
+
+		while( p < end && HOTSPOT_IS_SPACE( *p ) ) p++;
+		name = p;
+		while( p < end && ! HOTSPOT_IS_SPACE( *p ) ) p++;
+		nameLen = p - name;
+		if( nameLen == 0 )
+		{
+			return false;
+		}
+
+		while( p < end && HOTSPOT_IS_SPACE( *p ) ) p++;
+		bool negative = false;
+		if( p < end && ( *p == '-' || *p == '+' ) )
+		{
+			negative = ( *p == '-' );
+			p++;
+		}
+		if( p == end || static_cast< unsigned char >( *p - '0' ) > 9 )
+		{
+			return false;
+		}
+		long long value = 0;
+		while( p < end && static_cast< unsigned char >( *p - '0' ) <= 9 )
+		{
+			if( value <= INT_MAX )
+			{
+				value = value * 10 + ( *p - '0' );
+			}
+			p++;
+		}
+		tagLoc = static_cast< int >( negative ? -value : value );
+		return true;
+
+		#undef HOTSPOT_IS_SPACE
+	}
+
 	int InputDataReader::readNextChrom( std::vector< int >& tags )
 	{
-		std::string temp;
+		// Without a limit, the chromosome is always read to its end
+		bool chromEnded = false;
+		return readChromTags( tags, INT_MAX, chromEnded );
+	}
+
+	int InputDataReader::readChromTags( std::vector< int >& tags, int maxTags, bool& chromEnded )
+	{
 		int tagLoc = -1;
-		int numLines = 0;
-		char scannedChromName[ HotspotDefaults::MAX_CHROM_NAME_LEN + 1 ];
-		std::string chromName;
+		int numTags = 0;
+		const char* line;
+		const char* lineEnd;
+		const char* chromName;
+		std::size_t chromNameLen;
 
-		ByLine inputDataRecord;
+		chromEnded = false;
+		if( _binary )
+		{
+			chromEnded = true;
+			if( _binaryCorrupt )
+			{
+				return -1;
+			}
+			if( _nextBinaryChrom == _binaryChroms.size( ) )
+			{
+				return 0;
+			}
+			const BinaryTagLibrary::Chrom& chrom = _binaryChroms[ _nextBinaryChrom++ ];
+			if( ! BinaryTagLibrary::decodeTags( _map, chrom, tags ) )
+			{
+				std::fprintf( stderr, "Error: input file %s contains a malformed entry for %s\n", _inputFileName.c_str( ), chrom.name.c_str( ) );
+				_binaryCorrupt = true;
+				return -1;
+			}
+			_currentChromName = chrom.name;
+			_numChromsProcessed++;
+			_bytesParsed += chrom.length;
+			return chrom.numTags;
+		}
 
 		// Record residual data from last record scan
-		if( _hasMoreData )
+		if( ! _inChrom && _hasMoreData )
 		{
 			tags.push_back( _nextTag );
 			_currentChromName = _nextChromName;
 			_numChromsProcessed++;
 			_hasMoreData = false;
+			_inChrom = true;
+			_chromLines = 0;
+			numTags++;
 		}
 
-		while( _inputDataStream >> inputDataRecord  )
+		while( numTags < maxTags && nextLine( line, lineEnd ) )
 		{
 			// Scan and validate an input record
-			int numScanned = std::sscanf( inputDataRecord.c_str( ), "%s %d",
-					scannedChromName, &tagLoc );
-			if( numScanned != 2 )
+			if( ! parseRecord( line, lineEnd, chromName, chromNameLen, tagLoc ) )
 			{
 				std::fprintf( stderr, "Error: input file %s contains a malformed entry on line %d\n",
-						_inputFileName.c_str( ), numLines + 1 );
+						_inputFileName.c_str( ), _chromLines + 1 );
 				return -1;
 			}
-			chromName = scannedChromName;
 
-			if( _numChromsProcessed == 0 )
+			if( ! _inChrom )
 			{
-				_currentChromName = chromName;
+				_currentChromName.assign( chromName, chromNameLen );
 				_numChromsProcessed++;
+				_inChrom = true;
+				_chromLines = 0;
 			}
 			else
 			{
 				// This record belongs to the next chrom.  Save the data for the next caller
-				if( chromName.compare( _currentChromName ) != 0 )
+				if( chromNameLen != _currentChromName.size( )
+					|| std::memcmp( chromName, _currentChromName.data( ), chromNameLen ) != 0 )
 				{
 					_nextTag = tagLoc;
-					_nextChromName = chromName;
+					_nextChromName.assign( chromName, chromNameLen );
 					_hasMoreData = true;
-					return numLines;
+					_inChrom = false;
+					chromEnded = true;
+					return numTags;
 				}
 			}
 
 			tags.push_back( tagLoc );
-			numLines++;
+			_chromLines++;
+			numTags++;
 		}
-		return numLines;
+
+		// Out of input
+		if( numTags < maxTags )
+		{
+			_inChrom = false;
+			chromEnded = true;
+		}
+		return numTags;
 	}
 }
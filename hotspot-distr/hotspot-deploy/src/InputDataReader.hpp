@@ -8,16 +8,23 @@
  *  Read input data, formatted as one or more lines
  *  of <string> <int> (a single space delimits the fields).
  *  Input is fetched a chromosome at a time, and stored in a vector
+ *
+ *  A regular file is memory-mapped and parsed in place; other inputs
+ *  are read through a fixed-size buffer.  Chromosome names are compared
+ *  where they lie in the input, and only copied when the chromosome changes.
+ *
+ *  A memory-mapped file in the format of BinaryTagLibrary.hpp is detected
+ *  by its magic number, and decoded instead of parsed.
  */
 
 #ifndef INPUTDATAREADER_HPP_
 #define INPUTDATAREADER_HPP_
 
+#include <cstddef>
 #include <string>
 #include <vector>
-#include <fstream>
 
-#include "ByLine.hpp"
+#include "BinaryTagLibrary.hpp"
 
 namespace hotspot
 {
@@ -27,7 +34,8 @@ namespace hotspot
 	public:
 
 		/**
-		 * Init the input data reader with a valid file name
+		 * Init the input data reader with a valid file name, or "-" for
+		 * standard input
 		 */
 		InputDataReader( const std::string& inputFileName );
 
@@ -36,9 +44,36 @@ namespace hotspot
 		 *    results are appended to <tags>.  This method is
 		 *    a forward-only read operation, so each call returns
 		 *    results from the next chromosome in the input file.
+		 *    Returns the number of tags appended, 0 at the end of
+		 *    the input, or -1 on a malformed line.
 		 */
 		int readNextChrom( std::vector< int >& tags );
 
+		/**
+		 * Incremental form of readNextChrom( ): append at most <maxTags> more
+		 *   tags of the current chromosome to <tags>.  <chromEnded> is set
+		 *   once the chromosome has no more tags, and the next call starts
+		 *   the next chromosome.  Returns the number of tags appended, which
+		 *   is 0 with <chromEnded> set at the end of the input, or -1 on a
+		 *   malformed line.  A binary library is read a whole chromosome
+		 *   at a time.
+		 */
+		int readChromTags( std::vector< int >& tags, int maxTags, bool& chromEnded );
+
+		/**
+		 * Read the tags of chromosome <chromName> into <tags>, independent of
+		 * the position used by readNextChrom( ).  Only binary libraries have
+		 * the index this needs.  Returns the number of tags appended, or -1
+		 * for a text library, a missing chromosome, or corrupt data.
+		 */
+		int readChrom( const std::string& chromName, std::vector< int >& tags ) const;
+
+		/**
+		 * True if the input is a regular file, rather than a pipe or a terminal.
+		 * Only a regular file can be counted with numLines( ), or memory-mapped.
+		 */
+		bool isRegularFile( ) const;
+
 		/**
 		 * Returns the name of the most recently processed chromosome
 		 */
@@ -55,16 +90,65 @@ namespace hotspot
 		 */
 		int numLines( ) const;
 
+		/**
+		 * Look up the number of tags in the input file without reading it,
+		 * from the header of a binary library, or else from the <input>.counts
+		 * file that the pipeline writes alongside a text library.  Returns false
+		 * if there is no such file, or if it is older than the library.
+		 */
+		bool tagCount( int& count ) const;
+
+		/**
+		 * Bytes and lines of input parsed so far.  A binary library counts
+		 * the bytes of the chromosomes decoded, and has no lines.
+		 */
+		long long bytesParsed( ) const;
+		long long linesParsed( ) const;
+
 	private:
+		InputDataReader( const InputDataReader& );
+		InputDataReader& operator=( const InputDataReader& );
+
+		// Set [line, lineEnd) to the next input line, without its newline
+		bool nextLine( const char*& line, const char*& lineEnd );
+
+		// Refill _buffer when the input is not memory-mapped
+		bool fillBuffer( );
+
+		// Split a line into its chromosome name and tag position, as
+		// sscanf( line, "%s %d", ... ) would.  Returns false if malformed.
+		static bool parseRecord( const char* line, const char* lineEnd,
+								 const char*& name, std::size_t& nameLen, int& tagLoc );
+
 		std::string _inputFileName;
-		std::ifstream _inputDataStream;
+		int _fd;
 		std::string _currentChromName;
 
+		// Input data: the whole file when memory-mapped, else a window of it
+		const char* _map;
+		std::size_t _mapSize;
+		std::vector< char > _buffer;
+		const char* _cursor;
+		const char* _end;
+		bool _eof;
+
+		// Index of a binary library, and the next chromosome to read from it
+		bool _binary;
+		bool _binaryCorrupt;
+		uint64_t _binaryTotalTags;
+		std::vector< BinaryTagLibrary::Chrom > _binaryChroms;
+		unsigned int _nextBinaryChrom;
+
 		// Iteration helpers
 		int _nextTag;
 		std::string _nextChromName;
 		bool _hasMoreData;
 		int _numChromsProcessed;
+		bool _inChrom;      // a chromosome is partly read
+		int _chromLines;    // lines read so far from the current chromosome
+		long long _bytesParsed;
+		long long _linesParsed;
+		bool _regularFile;
 	};
 
 } // namespace hotspot
@@ -0,0 +1,267 @@
+/**
+ * File: IntervalSet.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  An implementation of IntervalSet.hpp
+ */
+
+#include "IntervalSet.hpp"
+#include "HotspotDefaults.hpp"
+#include "ByLine.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <set>
+
+namespace hotspot
+{
+
+	void IntervalSet::merge( )
+	{
+		std::sort( _intervals.begin( ), _intervals.end( ) );
+		unsigned int last = 0;
+		for( unsigned int i = 1; i < _intervals.size( ); i++ )
+		{
+			if( _intervals[i].start <= _intervals[last].end )
+			{
+				_intervals[last].end = std::max( _intervals[last].end, _intervals[i].end );
+			}
+			else
+			{
+				_intervals[++last] = _intervals[i];
+			}
+		}
+		if( ! _intervals.empty( ) )
+		{
+			_intervals.resize( last + 1, _intervals[0] );
+		}
+	}
+
+	void IntervalSet::pad( int width )
+	{
+		for( unsigned int i = 0; i < _intervals.size( ); i++ )
+		{
+			_intervals[i].start = std::max( _intervals[i].start - width, 0 );
+			_intervals[i].end += width;
+		}
+		merge( );
+	}
+
+	void IntervalSet::shrink( int width )
+	{
+		for( unsigned int i = 0; i < _intervals.size( ); i++ )
+		{
+			if( _intervals[i].start != 0 )
+			{
+				_intervals[i].start += width;
+			}
+			_intervals[i].end -= width;
+		}
+	}
+
+	void IntervalSet::subtract( const IntervalSet& other )
+	{
+		std::vector< Interval > result;
+		const std::vector< Interval >& cut = other._intervals;
+		unsigned int j = 0;
+		for( unsigned int i = 0; i < _intervals.size( ); i++ )
+		{
+			int start = _intervals[i].start;
+			int end = _intervals[i].end;
+			while( j < cut.size( ) && cut[j].end <= start )
+			{
+				j++;
+			}
+			for( unsigned int k = j; k < cut.size( ) && cut[k].start < end; k++ )
+			{
+				if( cut[k].start > start )
+				{
+					result.push_back( Interval( start, cut[k].start ) );
+				}
+				start = std::max( start, cut[k].end );
+			}
+			if( start < end )
+			{
+				result.push_back( Interval( start, end ) );
+			}
+		}
+		_intervals.swap( result );
+	}
+
+	void IntervalSet::intersect( const IntervalSet& other )
+	{
+		std::vector< Interval > result;
+		const std::vector< Interval >& keep = other._intervals;
+		unsigned int i = 0, j = 0;
+		while( i < _intervals.size( ) && j < keep.size( ) )
+		{
+			int start = std::max( _intervals[i].start, keep[j].start );
+			int end = std::min( _intervals[i].end, keep[j].end );
+			if( start < end )
+			{
+				result.push_back( Interval( start, end ) );
+			}
+			if( _intervals[i].end < keep[j].end )
+			{
+				i++;
+			}
+			else
+			{
+				j++;
+			}
+		}
+		_intervals.swap( result );
+	}
+
+	void IntervalSet::selectTags( const std::vector< int >& tags, std::vector< std::pair< int, int > >& ranges ) const
+	{
+		std::vector< int >::const_iterator from = tags.begin( );
+		for( unsigned int i = 0; i < _intervals.size( ); i++ )
+		{
+			std::vector< int >::const_iterator first = std::lower_bound( from, tags.end( ), _intervals[i].start );
+			std::vector< int >::const_iterator last = std::lower_bound( first, tags.end( ), _intervals[i].end );
+			if( last > first )
+			{
+				ranges.push_back( std::make_pair( first - tags.begin( ), last - tags.begin( ) ) );
+			}
+			from = last;
+		}
+	}
+
+	// Orders intervals by end, for finding the first one past a position
+	static bool endsBefore( const Interval& interval, int pos )
+	{
+		return interval.end <= pos;
+	}
+
+	long long IntervalSet::coverage( int start, int end ) const
+	{
+		long long bases = 0;
+		std::vector< Interval >::const_iterator i = std::lower_bound( _intervals.begin( ), _intervals.end( ), start, endsBefore );
+		for( ; i != _intervals.end( ) && i->start < end; ++i )
+		{
+			int overlap = std::min( i->end, end ) - std::max( i->start, start );
+			if( overlap > 0 )
+			{
+				bases += overlap;
+			}
+		}
+		return bases;
+	}
+
+	bool ReadBedChroms( const std::string& fileName, BedChromVisitor& visitor )
+	{
+		std::ifstream bed( fileName.c_str( ) );
+		if( ! bed )
+		{
+			std::fprintf( stderr, "Error: unable to access %s\n", fileName.c_str( ) );
+			return false;
+		}
+
+		char chromName[ HotspotDefaults::MAX_CHROM_NAME_LEN + 1 ];
+		int start, end;
+		int lineNum = 0;
+		ByLine line;
+		std::string currentChrom;
+		IntervalSet regions;
+		std::set< std::string > seen;
+		while( true )
+		{
+			bool more = ! ( bed >> line ).fail( );
+			if( more )
+			{
+				lineNum++;
+				if( line.empty( ) || line[0] == '#' || line.compare( 0, 5, "track" ) == 0
+					|| line.compare( 0, 7, "browser" ) == 0 )
+				{
+					continue;
+				}
+				if( std::sscanf( line.c_str( ), "%127s %d %d", chromName, &start, &end ) != 3 )
+				{
+					std::fprintf( stderr, "Error: input file %s contains a malformed entry on line %d\n",
+							fileName.c_str( ), lineNum );
+					return false;
+				}
+				if( currentChrom == chromName )
+				{
+					regions.add( start, end );
+					continue;
+				}
+			}
+
+			// Done with the regions of currentChrom
+			if( ! seen.empty( ) )
+			{
+				regions.merge( );
+				visitor.visit( currentChrom, regions );
+			}
+			if( ! more )
+			{
+				break;
+			}
+			if( ! seen.insert( chromName ).second )
+			{
+				std::fprintf( stderr, "Error: %s must be sorted; %s appears in more than one place\n",
+						fileName.c_str( ), chromName );
+				return false;
+			}
+			currentChrom = chromName;
+			regions.clear( );
+			regions.add( start, end );
+		}
+		return true;
+	}
+
+	/**
+	 * Intersects the sets of IntersectWithBed( ) with the regions of each
+	 * chromosome in turn
+	 */
+	class BedIntersector : public BedChromVisitor
+	{
+	public:
+		BedIntersector( std::map< std::string, IntervalSet >& sets ) : _sets( sets ) { }
+
+		void visit( const std::string& chromName, IntervalSet& regions )
+		{
+			std::map< std::string, IntervalSet >::iterator set = _sets.find( chromName );
+			if( set != _sets.end( ) )
+			{
+				set->second.intersect( regions );
+				_seen.insert( chromName );
+			}
+		}
+
+		// Chromosomes with no regions at all keep nothing
+		void finish( )
+		{
+			std::map< std::string, IntervalSet >::iterator i;
+			for( i = _sets.begin( ); i != _sets.end( ); ++i )
+			{
+				if( _seen.find( i->first ) == _seen.end( ) )
+				{
+					i->second.clear( );
+				}
+			}
+		}
+
+	private:
+		std::map< std::string, IntervalSet >& _sets;
+		std::set< std::string > _seen;
+	};
+
+	bool IntersectWithBed( const std::string& fileName, std::map< std::string, IntervalSet >& sets )
+	{
+		BedIntersector intersector( sets );
+		if( ! ReadBedChroms( fileName, intersector ) )
+		{
+			return false;
+		}
+		intersector.finish( );
+		return true;
+	}
+}
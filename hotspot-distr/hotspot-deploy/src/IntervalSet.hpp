@@ -0,0 +1,126 @@
+/**
+ * File: IntervalSet.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  Half-open intervals [start, end) on one chromosome, with the few
+ *  set operations the pipeline scripts perform with bedops: merge,
+ *  pad, difference and intersection.  Intervals are added in any
+ *  order; merge( ) sorts them and joins those that overlap or touch,
+ *  as bedops --merge does.  The other operations expect merged sets,
+ *  and leave their result merged.
+ */
+
+#ifndef INTERVAL_SET_HPP_
+#define INTERVAL_SET_HPP_
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hotspot
+{
+
+	struct Interval
+	{
+		int start;
+		int end;
+
+		Interval( int s, int e ) : start( s ), end( e ) { }
+		bool operator<( const Interval& other ) const
+		{
+			return start < other.start || ( start == other.start && end < other.end );
+		}
+	};
+
+	class IntervalSet
+	{
+	public:
+		/**
+		 * Append [start, end)
+		 */
+		void add( int start, int end ) { _intervals.push_back( Interval( start, end ) ); }
+
+		/**
+		 * Sort the intervals, and join those that overlap or touch
+		 */
+		void merge( );
+
+		/**
+		 * Widen each interval by <width> on both sides, starting no lower than 0,
+		 * as bedops --range does, and merge the result
+		 */
+		void pad( int width );
+
+		/**
+		 * Narrow each interval by <width> on both sides, except that one
+		 * starting at 0 keeps its start: the reverse of pad( ) for intervals
+		 * that pad( ) merged, as the pipeline scripts compute it
+		 */
+		void shrink( int width );
+
+		/**
+		 * Remove every position in <other>, as bedops --difference does
+		 */
+		void subtract( const IntervalSet& other );
+
+		/**
+		 * Keep only the positions also in <other>, as bedops --intersect does
+		 */
+		void intersect( const IntervalSet& other );
+
+		/**
+		 * Index ranges [first, second) of the sorted <tags> whose positions
+		 * fall in the set
+		 */
+		void selectTags( const std::vector< int >& tags, std::vector< std::pair< int, int > >& ranges ) const;
+
+		/**
+		 * Number of positions in [start, end) that are also in the set
+		 */
+		long long coverage( int start, int end ) const;
+
+		const std::vector< Interval >& intervals( ) const { return _intervals; }
+		bool empty( ) const { return _intervals.empty( ); }
+		void clear( ) { _intervals.clear( ); }
+
+	private:
+		std::vector< Interval > _intervals;
+	};
+
+	/**
+	 * Receives the regions of a BED file, a chromosome at a time
+	 */
+	class BedChromVisitor
+	{
+	public:
+		virtual ~BedChromVisitor( ) { }
+
+		/**
+		 * <regions> holds every region listed for <chromName>, merged
+		 */
+		virtual void visit( const std::string& chromName, IntervalSet& regions ) = 0;
+	};
+
+	/**
+	 * Read the BED file <fileName>, and pass each chromosome's regions to
+	 * <visitor>, in file order.  The file is read once, so it can be a pipe,
+	 * and only one chromosome is held at a time; each chromosome's regions
+	 * must therefore be contiguous, as sort-bed leaves them.  Returns false,
+	 * after reporting why, if the file cannot be read or is malformed.
+	 */
+	bool ReadBedChroms( const std::string& fileName, BedChromVisitor& visitor );
+
+	/**
+	 * Intersect each set in <sets> with the regions listed for its chromosome
+	 * in the BED file <fileName>, read with ReadBedChroms( ).  Sets for
+	 * chromosomes missing from the file are emptied.
+	 */
+	bool IntersectWithBed( const std::string& fileName, std::map< std::string, IntervalSet >& sets );
+
+} // namespace hotspot
+
+#endif /* INTERVAL_SET_HPP_ */
@@ -0,0 +1,43 @@
+/**
+ * File: MappableCounts.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  An implementation of MappableCounts.hpp
+ */
+
+#include "MappableCounts.hpp"
+
+#include <algorithm>
+
+namespace hotspot
+{
+	void CountMappableBases( const Interval& extent, const std::vector< Interval >& regions, int binSize,
+							 std::vector< int >& counts )
+	{
+		long long length = std::max( 0, extent.end - extent.start );
+		counts.assign( ( length + binSize - 1 ) / binSize, 0 );
+		for( unsigned int i = 0; i < regions.size( ); i++ )
+		{
+			int start = std::max( regions[i].start, extent.start );
+			int end = std::min( regions[i].end, extent.end );
+			if( start >= end )
+			{
+				continue;
+			}
+
+			// Split the region at each bin boundary it crosses
+			int bin = ( start - extent.start ) / binSize;
+			int binEnd = extent.start + ( bin + 1 ) * binSize;
+			while( binEnd < end )
+			{
+				counts[ bin++ ] += binEnd - start;
+				start = binEnd;
+				binEnd += binSize;
+			}
+			counts[ bin ] += end - start;
+		}
+	}
+}
@@ -0,0 +1,36 @@
+/**
+ * File: MappableCounts.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  Counts of uniquely mappable bases in fixed-size bins, the background
+ *  read by MappableCountsDataReader, in place of the awk tiling and
+ *  bedmap --bases steps of run_10kb_counts.  Bins tile each chromosome
+ *  from its start, the last ending at the chromosome end.  Each region
+ *  adds the bases it shares with each bin it crosses, so the counts take
+ *  time in proportion to the regions plus the bins, in one pass.
+ */
+
+#ifndef MAPPABLE_COUNTS_HPP_
+#define MAPPABLE_COUNTS_HPP_
+
+#include <vector>
+
+#include "IntervalSet.hpp"
+
+namespace hotspot
+{
+
+	/**
+	 * Set <counts> to the mappable bases in each <binSize> bin of <extent>.
+	 * <regions> can be in any order, and a base covered by several regions
+	 * counts once for each, as bedmap --bases counts it.
+	 */
+	void CountMappableBases( const Interval& extent, const std::vector< Interval >& regions, int binSize,
+							 std::vector< int >& counts );
+
+} // namespace hotspot
+
+#endif /* MAPPABLE_COUNTS_HPP_ */
@@ -0,0 +1,302 @@
+/**
+ * File: MappableCountsBuilder.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  Entry point of hotspot-mapcounts, which writes the mappable counts
+ *  background (see MappableCounts.hpp) in place of run_10kb_counts.  The
+ *  mappable regions are read once, and each chromosome is counted on a
+ *  pool of threads as soon as its regions have all been read.  The
+ *  counts are written in the order of the chromosome file, as text in
+ *  the form hotspot -k reads, together with the binary cache that
+ *  MappableCountsDataReader would otherwise build on first use.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ByLine.hpp"
+#include "HotspotDefaults.hpp"
+#include "IntervalSet.hpp"
+#include "MappableCounts.hpp"
+#include "MappableCountsDataReader.hpp"
+#include "ThreadPool.hpp"
+
+namespace hotspot
+{
+	/**
+	 * Counts the mappable bases in the bins of one chromosome
+	 */
+	class BinCounter : public ThreadPool::Task
+	{
+	public:
+		std::string name;
+		Interval extent;
+		int binSize;
+		bool submitted;
+		std::vector< Interval > regions;
+		std::vector< int > counts;
+
+		BinCounter( ) : extent( 0, 0 ), binSize( 0 ), submitted( false ) { }
+
+		void run( )
+		{
+			CountMappableBases( extent, regions, binSize, counts );
+			std::vector< Interval >( ).swap( regions );
+		}
+	};
+
+	/**
+	 * Read the chromosomes of the BED file <fileName>, one line each, into
+	 * <counters>, and index them by name in <index>.  Returns false, after
+	 * reporting why, on error.
+	 */
+	bool ReadChroms( const std::string& fileName, int binSize, std::vector< BinCounter >& counters,
+					 std::map< std::string, unsigned int >& index )
+	{
+		std::ifstream in( fileName.c_str( ) );
+		if( ! in )
+		{
+			std::fprintf( stderr, "Error: unable to access %s\n", fileName.c_str( ) );
+			return false;
+		}
+
+		char chromName[ HotspotDefaults::MAX_CHROM_NAME_LEN + 1 ];
+		int start, end;
+		int lineNum = 0;
+		ByLine line;
+		while( in >> line )
+		{
+			lineNum++;
+			if( line.empty( ) )
+			{
+				continue;
+			}
+			if( std::sscanf( line.c_str( ), "%127s %d %d", chromName, &start, &end ) != 3 )
+			{
+				std::fprintf( stderr, "Error: input file %s contains a malformed entry on line %d\n",
+						fileName.c_str( ), lineNum );
+				return false;
+			}
+			if( ! index.insert( std::make_pair( std::string( chromName ), counters.size( ) ) ).second )
+			{
+				std::fprintf( stderr, "Error: %s lists %s more than once\n", fileName.c_str( ), chromName );
+				return false;
+			}
+			counters.push_back( BinCounter( ) );
+			counters.back( ).name = chromName;
+			counters.back( ).extent = Interval( start, end );
+			counters.back( ).binSize = binSize;
+		}
+		return true;
+	}
+
+	/**
+	 * Read the mappable regions of the BED file <fileName>, or standard input
+	 * for "-", into <counters>, and submit each chromosome to <pool> once its
+	 * regions are read.  Regions of chromosomes not in <index> are skipped.
+	 * Returns false, after reporting why, on error.
+	 */
+	bool ReadMappable( const std::string& fileName, std::vector< BinCounter >& counters,
+					   const std::map< std::string, unsigned int >& index,
+					   ThreadPool& pool, ThreadPool::TaskGroup& group )
+	{
+		std::ifstream file;
+		if( fileName != "-" )
+		{
+			file.open( fileName.c_str( ) );
+			if( ! file )
+			{
+				std::fprintf( stderr, "Error: unable to access %s\n", fileName.c_str( ) );
+				return false;
+			}
+		}
+		std::istream& in = ( fileName == "-" ) ? std::cin : file;
+
+		int lineNum = 0;
+		ByLine line;
+		std::string currentChrom;
+		BinCounter* counter = NULL;
+		while( in >> line )
+		{
+			lineNum++;
+			if( line.empty( ) )
+			{
+				continue;
+			}
+
+			// <chrom> <start> <end>, parsed without sscanf, as there are millions
+			const char* chromName = line.c_str( );
+			std::size_t nameLength = std::strcspn( chromName, " \t" );
+			char* p;
+			char* q;
+			long start = std::strtol( chromName + nameLength, &p, 10 );
+			long end = std::strtol( p, &q, 10 );
+			if( nameLength == 0 || p == chromName + nameLength || q == p )
+			{
+				std::fprintf( stderr, "Error: input file %s contains a malformed entry on line %d\n",
+						fileName.c_str( ), lineNum );
+				return false;
+			}
+			if( currentChrom.compare( 0, std::string::npos, chromName, nameLength ) != 0 )
+			{
+				if( counter != NULL )
+				{
+					pool.submit( counter, group );
+				}
+				currentChrom.assign( chromName, nameLength );
+				std::map< std::string, unsigned int >::const_iterator i = index.find( currentChrom );
+				counter = ( i == index.end( ) ) ? NULL : &counters[ i->second ];
+				if( counter != NULL && counter->submitted )
+				{
+					std::fprintf( stderr, "Error: %s must be sorted; %s appears in more than one place\n",
+							fileName.c_str( ), currentChrom.c_str( ) );
+					return false;
+				}
+				if( counter != NULL )
+				{
+					counter->submitted = true;
+				}
+			}
+			if( counter != NULL )
+			{
+				counter->regions.push_back( Interval( start, end ) );
+			}
+		}
+		if( counter != NULL )
+		{
+			pool.submit( counter, group );
+		}
+		return true;
+	}
+
+	/**
+	 * Write <counts>, the bins of <chromName> from <start>, to <fp> as lines
+	 * of <chrom> <bin start> <count>
+	 */
+	void WriteCounts( std::FILE* fp, const std::string& chromName, int start, int binSize,
+					  const std::vector< int >& counts )
+	{
+		char line[ HotspotDefaults::MAX_CHROM_NAME_LEN + 32 ];
+		for( unsigned int k = 0; k < counts.size( ); k++ )
+		{
+			int n = std::snprintf( line, sizeof( line ), "%s %d %d\n", chromName.c_str( ),
+					start + static_cast< int >( k ) * binSize, counts[k] );
+			std::fwrite( line, 1, n, fp );
+		}
+	}
+}
+
+int main( int argc, char **argv )
+{
+	std::string mappablePath, chromsPath, outputPath;
+	int binSize = hotspot::HotspotDefaults::DENSITY_WIN_SMALL;
+	int numThreads = hotspot::HotspotDefaults::NUM_THREADS;
+	for( int i = 1; i < argc; i++ )
+	{
+		bool hasValue = ( i + 1 < argc );
+		if( std::strcmp( argv[ i ], "-mappable" ) == 0 && hasValue )
+		{
+			mappablePath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-chroms" ) == 0 && hasValue )
+		{
+			chromsPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-o" ) == 0 && hasValue )
+		{
+			outputPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-bin" ) == 0 && hasValue )
+		{
+			binSize = std::atoi( argv[ ++i ] );
+		}
+		else if( std::strcmp( argv[ i ], "-threads" ) == 0 && hasValue )
+		{
+			numThreads = std::atoi( argv[ ++i ] );
+		}
+		else
+		{
+			std::cerr << "Unrecognized option: " << argv[ i ] << ". Aborting." << std::endl;
+			std::exit( EXIT_FAILURE );
+		}
+	}
+	if( mappablePath.empty( ) || chromsPath.empty( ) || outputPath.empty( ) || binSize <= 0 )
+	{
+		std::string msg  = "Usage: hotspot-mapcounts -mappable <file-name> -chroms <file-name> -o <file-name> [options]";
+		msg += "\n    -mappable <file-name> (uniquely mappable regions, sorted bed; - for standard input)";
+		msg += "\n    -chroms <file-name> (extent of each chromosome, bed)";
+		msg += "\n    -o <file-name> (output counts, as for hotspot -k; the binary cache goes to <file-name>.bin)";
+		msg += "\n    -bin <int> (bin size - default=10000)";
+		msg += "\n    -threads <int> (number of threads - default=1)";
+		msg += "\n";
+		std::cerr << msg << std::endl;
+		std::exit( EXIT_FAILURE );
+	}
+
+	std::vector< hotspot::BinCounter > counters;
+	std::map< std::string, unsigned int > index;
+	if( ! hotspot::ReadChroms( chromsPath, binSize, counters, index ) )
+	{
+		std::exit( EXIT_FAILURE );
+	}
+	{
+		hotspot::ThreadPool pool( numThreads );
+		hotspot::ThreadPool::TaskGroup group;
+		bool ok = hotspot::ReadMappable( mappablePath, counters, index, pool, group );
+
+		// Chromosomes with no mappable regions still get their bins
+		for( unsigned int c = 0; ok && c < counters.size( ); c++ )
+		{
+			if( ! counters[c].submitted )
+			{
+				counters[c].submitted = true;
+				pool.submit( &counters[c], group );
+			}
+		}
+		pool.wait( group );
+		if( ! ok )
+		{
+			std::exit( EXIT_FAILURE );
+		}
+	}
+
+	std::FILE* fp = std::fopen( outputPath.c_str( ), "w" );
+	if( fp == NULL )
+	{
+		std::fprintf( stderr, "Error: unable to open %s\n", outputPath.c_str( ) );
+		std::exit( EXIT_FAILURE );
+	}
+	std::map< std::string, std::vector< int > > counts;
+	for( unsigned int c = 0; c < counters.size( ); c++ )
+	{
+		hotspot::BinCounter& counter = counters[c];
+		hotspot::WriteCounts( fp, counter.name, counter.extent.start, binSize, counter.counts );
+		if( ! counter.counts.empty( ) )
+		{
+			counts[ counter.name ].swap( counter.counts ); // as the text lists it
+		}
+	}
+	bool ok = ! std::ferror( fp );
+	ok = ( std::fclose( fp ) == 0 ) && ok;
+	if( ! ok )
+	{
+		std::fprintf( stderr, "Error: unable to write %s\n", outputPath.c_str( ) );
+		std::remove( outputPath.c_str( ) );
+		std::exit( EXIT_FAILURE );
+	}
+	if( ! hotspot::MappableCountsDataReader::writeCache( outputPath, counts ) )
+	{
+		std::cerr << "Warning: unable to write the binary cache of " << outputPath
+				  << "; hotspot will build it on first use" << std::endl;
+	}
+	std::exit( EXIT_SUCCESS );
+}
@@ -14,25 +14,69 @@
 
 #include <string>
 #include <cstdio>
-#include <istream>
-#include <exception>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 #include <vector>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 namespace hotspot
 {
+	// Layout of the cache file: this header, each chromosome's counts as
+	// native ints, then the chromosome table.  The cache is only ever read
+	// on the machine that wrote it, or one like it.
+	struct MappableCountsCacheHeader
+	{
+		char magic[8];
+		uint32_t byteOrder;
+		uint32_t numChroms;
+		uint64_t textSize;
+		int64_t textMtime;
+		int64_t textMtimeNsec;
+		uint64_t tableOffset;
+	};
+
+	// One chromosome table entry, followed by its name
+	struct MappableCountsCacheEntry
+	{
+		uint32_t numBins;
+		uint32_t nameLength;
+		uint64_t offset;
+	};
 
+	static const char CACHE_MAGIC[] = "HSBGCNT1";
+	static const uint32_t CACHE_BYTE_ORDER = 0x01020304;
+
+	static std::string CacheFileName( const std::string& inputFileName )
+	{
+		return inputFileName + ".bin";
+	}
 
 	MappableCountsDataReader::MappableCountsDataReader( const std::string& inputFileName )
-				: _inputFileName( inputFileName ), _recordNum( 0 )
+				: _inputFileName( inputFileName ), _malformed( false ), _map( NULL ), _mapSize( 0 )
 	{
-		_inputDataStream.open( _inputFileName.c_str( ) );
+		struct stat st;
+		if( stat( _inputFileName.c_str( ), &st ) != 0 )
+		{
+			return; // no background counts at all
+		}
+
+		std::string cacheFileName = CacheFileName( _inputFileName );
+		if( ! mapCache( cacheFileName ) )
+		{
+			buildCache( cacheFileName );
+		}
 	}
 
 	MappableCountsDataReader::~MappableCountsDataReader()
 	{
-		if( _inputDataStream )
+		if( _map != NULL )
 		{
-			_inputDataStream.close( );
+			munmap( const_cast< char* >( _map ), _mapSize );
 		}
 	}
 
@@ -48,78 +92,215 @@ namespace hotspot
 		return numLines;
 	}
 
-	int MappableCountsDataReader::readChrom( const std::string& matchChromName, std::vector< int >& mappableCounts )
+	int MappableCountsDataReader::readChrom( const std::string& matchChromName, std::vector< int >& mappableCounts ) const
 	{
+		if( _malformed )
+		{
+			return -1;
+		}
+		std::map< std::string, ChromCounts >::const_iterator chrom = _chroms.find( matchChromName );
+		if( chrom == _chroms.end( ) )
+		{
+			return 0;
+		}
+		mappableCounts.insert( mappableCounts.end( ), chrom->second.counts, chrom->second.counts + chrom->second.numBins );
+		return chrom->second.numBins;
+	}
+
+	bool MappableCountsDataReader::mapCache( const std::string& cacheFileName )
+	{
+		struct stat textStat;
+		if( stat( _inputFileName.c_str( ), &textStat ) != 0 )
+		{
+			return false;
+		}
+		int fd = open( cacheFileName.c_str( ), O_RDONLY );
+		if( fd < 0 )
+		{
+			return false;
+		}
+		struct stat cacheStat;
+		void* map = MAP_FAILED;
+		if( fstat( fd, &cacheStat ) == 0 && cacheStat.st_size >= static_cast< off_t >( sizeof( MappableCountsCacheHeader ) ) )
+		{
+			map = mmap( NULL, cacheStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+		}
+		close( fd );
+		if( map == MAP_FAILED )
+		{
+			return false;
+		}
+		const char* data = static_cast< const char* >( map );
+		std::size_t size = cacheStat.st_size;
+
+		// The cache must have been built from the text file as it is now
+		MappableCountsCacheHeader header;
+		std::memcpy( &header, data, sizeof( header ) );
+		bool valid = std::memcmp( header.magic, CACHE_MAGIC, sizeof( header.magic ) ) == 0
+			&& header.byteOrder == CACHE_BYTE_ORDER
+			&& header.textSize == static_cast< uint64_t >( textStat.st_size )
+			&& header.textMtime == static_cast< int64_t >( textStat.st_mtim.tv_sec )
+			&& header.textMtimeNsec == static_cast< int64_t >( textStat.st_mtim.tv_nsec )
+			&& header.tableOffset >= sizeof( header ) && header.tableOffset <= size;
+
+		std::map< std::string, ChromCounts > chroms;
+		const char* p = data + header.tableOffset;
+		const char* end = data + size;
+		for( uint32_t i = 0; valid && i < header.numChroms; i++ )
+		{
+			MappableCountsCacheEntry entry;
+			if( static_cast< std::size_t >( end - p ) < sizeof( entry ) )
+			{
+				valid = false;
+				break;
+			}
+			std::memcpy( &entry, p, sizeof( entry ) );
+			p += sizeof( entry );
+			if( static_cast< std::size_t >( end - p ) < entry.nameLength
+				|| entry.offset < sizeof( header ) || entry.offset % sizeof( int ) != 0
+				|| entry.offset > header.tableOffset
+				|| entry.numBins > ( header.tableOffset - entry.offset ) / sizeof( int ) )
+			{
+				valid = false;
+				break;
+			}
+			ChromCounts counts;
+			counts.counts = reinterpret_cast< const int* >( data + entry.offset );
+			counts.numBins = entry.numBins;
+			chroms[ std::string( p, entry.nameLength ) ] = counts;
+			p += entry.nameLength;
+		}
+		if( ! valid )
+		{
+			munmap( map, size );
+			return false;
+		}
+
+		_map = data;
+		_mapSize = size;
+		_chroms.swap( chroms );
+		return true;
+	}
+
+	bool MappableCountsDataReader::buildCache( const std::string& cacheFileName )
+	{
+		struct stat textStat;
+		std::ifstream inputDataStream( _inputFileName.c_str( ) );
+		if( ! inputDataStream || stat( _inputFileName.c_str( ), &textStat ) != 0 )
+		{
+			return false;
+		}
 
 		// Storage for input reads
 		int start;
 		char scannedChromName[ HotspotDefaults::MAX_CHROM_NAME_LEN + 1 ];
 		int densityCount;
 
-		// Iteration helpers
-		int numChromLines = 0;
+		// Each chromosome's counts, in file order
+		int recordNum = 0;
 		ByLine inputDataRecord;
-
-		while( _inputDataStream >> inputDataRecord  )
+		std::vector< int >* counts = NULL;
+		std::string chromName;
+		while( inputDataStream >> inputDataRecord )
 		{
-			_recordNum++;
-			// Process residual record, if present
-			if( ! _nextLine.empty( ) )
-			{
-				const std::string *scanResidual = _nextLine.top( );
-				_nextLine.pop( );
-				// Scan and validate the current record
-				int numScanned = std::sscanf( scanResidual->c_str( ), "%s %d %d",
-						scannedChromName, &start, &densityCount );
-				if( numScanned != 3 )
-				{
-					std::fprintf( stderr, "Error processing residual: input file %s contains a malformed entry on line %d\n",
-							_inputFileName.c_str( ), _recordNum );
-					std::fprintf( stderr, "Details: input line: %s, num records scanned: %d, num residual items: %ld\n", scanResidual->c_str( ), numScanned, _nextLine.size( )  );
-					return -1;
-				}
-				if(! matchChromName.compare( scannedChromName ) )
-				{
-						// Record matches chrom
-					mappableCounts.push_back( densityCount );
-					numChromLines++;
-				}
-				delete scanResidual;
-			}
-
+			recordNum++;
 			// Scan and validate the current record
 			int numScanned = std::sscanf( inputDataRecord.c_str( ), "%s %d %d",
 					scannedChromName, &start, &densityCount );
 			if( numScanned != 3 )
 			{
 				std::fprintf( stderr, "Error: input file %s contains a malformed entry on line %d\n",
-						_inputFileName.c_str( ), _recordNum );
+						_inputFileName.c_str( ), recordNum );
 				std::fprintf( stderr, "Details: input line: %s, num records scanned: %d\n", inputDataRecord.c_str( ), numScanned );
-				return -1;
+				_malformed = true;
+				return false;
 			}
-
-			if( matchChromName.compare( scannedChromName ) )
-			{
-				// Record does not match chrom
-				if (numChromLines == 0 )
-				{
-					continue;
-				}
-				else
-				{
-					//std::cerr << "Pushing: " << inputDataRecord.c_str( ) << std::endl;
-					_nextLine.push( new std::string( inputDataRecord.c_str( ) ) );
-					numChromLines++;
-					break;
-				}
-			}
-			else
+			if( counts == NULL || chromName.compare( scannedChromName ) )
 			{
-				// Record matches chrom
-				mappableCounts.push_back( densityCount );
-				numChromLines++;
+				chromName = scannedChromName;
+				counts = &_unmappedCounts[ chromName ];
 			}
+			counts->push_back( densityCount );
+		}
+
+		bool written = writeCache( _inputFileName, textStat, _unmappedCounts );
+		if( written && mapCache( cacheFileName ) )
+		{
+			_unmappedCounts.clear( );
+			return true;
+		}
+
+		// No cache: serve the counts from memory
+		std::map< std::string, std::vector< int > >::const_iterator i;
+		for( i = _unmappedCounts.begin( ); i != _unmappedCounts.end( ); ++i )
+		{
+			ChromCounts counts;
+			counts.counts = i->second.empty( ) ? NULL : &i->second[0];
+			counts.numBins = i->second.size( );
+			_chroms[ i->first ] = counts;
+		}
+		return false;
+	}
+
+	bool MappableCountsDataReader::writeCache( const std::string& inputFileName,
+											   const std::map< std::string, std::vector< int > >& counts )
+	{
+		struct stat textStat;
+		return stat( inputFileName.c_str( ), &textStat ) == 0 && writeCache( inputFileName, textStat, counts );
+	}
+
+	bool MappableCountsDataReader::writeCache( const std::string& inputFileName, const struct stat& textStat,
+											   const std::map< std::string, std::vector< int > >& counts )
+	{
+		// Write the cache under a temporary name, so that concurrent runs
+		// never see a partial file
+		std::string cacheFileName = CacheFileName( inputFileName );
+		std::ostringstream tmpFileName;
+		tmpFileName << cacheFileName << ".tmp" << getpid( );
+		std::FILE* fp = std::fopen( tmpFileName.str( ).c_str( ), "wb" );
+		if( fp == NULL )
+		{
+			return false;
+		}
+
+		MappableCountsCacheHeader header;
+		std::memset( &header, 0, sizeof( header ) );
+		std::memcpy( header.magic, CACHE_MAGIC, sizeof( header.magic ) );
+		header.byteOrder = CACHE_BYTE_ORDER;
+		header.numChroms = counts.size( );
+		header.textSize = textStat.st_size;
+		header.textMtime = textStat.st_mtim.tv_sec;
+		header.textMtimeNsec = textStat.st_mtim.tv_nsec;
+		header.tableOffset = sizeof( header );
+
+		std::map< std::string, std::vector< int > >::const_iterator i;
+		for( i = counts.begin( ); i != counts.end( ); ++i )
+		{
+			header.tableOffset += i->second.size( ) * sizeof( int );
+		}
+		bool written = std::fwrite( &header, sizeof( header ), 1, fp ) == 1;
+		for( i = counts.begin( ); written && i != counts.end( ); ++i )
+		{
+			written = i->second.empty( )
+				|| std::fwrite( &i->second[0], sizeof( int ), i->second.size( ), fp ) == i->second.size( );
+		}
+		uint64_t offset = sizeof( header );
+		for( i = counts.begin( ); written && i != counts.end( ); ++i )
+		{
+			MappableCountsCacheEntry entry;
+			entry.numBins = i->second.size( );
+			entry.nameLength = i->first.size( );
+			entry.offset = offset;
+			offset += i->second.size( ) * sizeof( int );
+			written = std::fwrite( &entry, sizeof( entry ), 1, fp ) == 1
+				&& std::fwrite( i->first.data( ), 1, i->first.size( ), fp ) == i->first.size( );
+		}
+		written = ( std::fclose( fp ) == 0 ) && written;
+		written = written && std::rename( tmpFileName.str( ).c_str( ), cacheFileName.c_str( ) ) == 0;
+		if( ! written )
+		{
+			std::remove( tmpFileName.str( ).c_str( ) );
 		}
-		return numChromLines;
+		return written;
 	}
 }
@@ -5,20 +5,26 @@
  * Version: $Id$
  *
  * Comments:
- *  Read background data.  Input is fetched a chromosome at a time, and
- *  stored in a vector.  An input data record is formatted as: <string> <int> <int>
- *  (a single space delimits fields).
+ *  Read background data.  An input data record is formatted as:
+ *  <string> <int> <int> (a single space delimits fields), and gives the
+ *  count of mappable sites in one bin of a chromosome.
+ *
+ *  The counts are indexed by chromosome the first time a counts file is
+ *  used, and saved in a binary cache next to it (<input>.bin).  Later
+ *  runs memory-map the cache instead of parsing the text.  The cache
+ *  records the size and modification time of the text it was built
+ *  from, and is rebuilt when they no longer match.  Any chromosome can
+ *  be read at any time, in any order, from any thread.
  */
 
 #ifndef MAPPABLE_COUNTS_DATA_READER_HPP_
 #define MAPPABLE_COUNTS_DATA_READER_HPP_
 
+#include <cstddef>
+#include <map>
 #include <string>
 #include <vector>
-#include <stack>
-#include <fstream>
-
-#include "ByLine.hpp"
+#include <sys/stat.h>
 
 namespace hotspot
 {
@@ -36,24 +42,56 @@ namespace hotspot
 		~MappableCountsDataReader();
 
 		/**
-		 *  Obtain the next chrom of information from file.
-		 *    results are appended to <tags>.  This method is
-		 *    a forward-only read operation, so each call returns
-		 *    results from the next chromosome in the input file.
+		 *  Obtain the counts for chromosome <chromName>, in bin order.
+		 *    Results are appended to <mappableCounts>.  Returns the
+		 *    number of bins, 0 if the chromosome is not in the file,
+		 *    or -1 if the file is malformed.
 		 */
-		int readChrom( const std::string& chromName,  std::vector< int>& tags );
+		int readChrom( const std::string& chromName,  std::vector< int >& mappableCounts ) const;
 
 		/**
-		 * Count and return the number of lines in the input file. This method
-		 * does not affect the underlying position used by readChrom( )
+		 * Count and return the number of lines in the input file.
 		 */
 		int numLines( ) const;
 
+		/**
+		 * Write the binary cache of counts file <inputFileName>, holding
+		 * <counts> by chromosome, as a reader would build it on first use.
+		 * The counts file must already be complete.  Returns false if the
+		 * cache cannot be written.
+		 */
+		static bool writeCache( const std::string& inputFileName,
+								const std::map< std::string, std::vector< int > >& counts );
+
 	private:
+		MappableCountsDataReader( const MappableCountsDataReader& );
+		MappableCountsDataReader& operator=( const MappableCountsDataReader& );
+
+		// Where a chromosome's counts lie in the cache
+		struct ChromCounts
+		{
+			const int* counts;
+			int numBins;
+		};
+
+		// Parse the text file, and write its counts to the cache file
+		bool buildCache( const std::string& cacheFileName );
+
+		// Write the cache of <counts>, read from the text file as <textStat> describes it
+		static bool writeCache( const std::string& inputFileName, const struct stat& textStat,
+								const std::map< std::string, std::vector< int > >& counts );
+
+		// Map the cache file and index it, if it matches the text file
+		bool mapCache( const std::string& cacheFileName );
+
 		std::string _inputFileName;
-		int _recordNum;
-		std::ifstream _inputDataStream;
-		std::stack< const std::string* > _nextLine;
+		bool _malformed;
+		const char* _map;
+		std::size_t _mapSize;
+		std::map< std::string, ChromCounts > _chroms;
+
+		// Counts held in memory when the cache cannot be written
+		std::map< std::string, std::vector< int > > _unmappedCounts;
 };
 
 } // namespace hotspot
@@ -0,0 +1,62 @@
+/**
+ * File: OrderedOutput.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  An implementation of OrderedOutput.hpp
+ */
+
+#include "OrderedOutput.hpp"
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+namespace hotspot
+{
+
+	OrderedOutput::OrderedOutput( std::FILE* fp, int numChunks )
+		: _fp( fp ), _data( numChunks, NULL ), _log( numChunks, NULL ), _nextChunk( 0 )
+	{
+		pthread_mutex_init( &_lock, NULL );
+	}
+
+	OrderedOutput::~OrderedOutput( )
+	{
+		for( unsigned int i = 0; i < _data.size( ); i++ )
+		{
+			delete _data[i];
+			delete _log[i];
+		}
+		pthread_mutex_destroy( &_lock );
+	}
+
+	void OrderedOutput::complete( int chunk, std::string& data, std::string& log )
+	{
+		pthread_mutex_lock( &_lock );
+		_data[ chunk ] = new std::string( );
+		_data[ chunk ]->swap( data );
+		_log[ chunk ] = new std::string( );
+		_log[ chunk ]->swap( log );
+
+		// Drain every chunk that is now at the head of the line
+		while( _nextChunk < static_cast< int >( _data.size( ) ) && _data[ _nextChunk ] != NULL )
+		{
+			std::cerr << *_log[ _nextChunk ];
+			std::cerr.flush( );
+			if( _fp != NULL )
+			{
+				std::fwrite( _data[ _nextChunk ]->data( ), 1, _data[ _nextChunk ]->size( ), _fp );
+				std::fflush( _fp );
+			}
+			delete _data[ _nextChunk ];
+			delete _log[ _nextChunk ];
+			_data[ _nextChunk ] = NULL;
+			_log[ _nextChunk ] = NULL;
+			_nextChunk++;
+		}
+		pthread_mutex_unlock( &_lock );
+	}
+}
@@ -0,0 +1,55 @@
+/**
+ * File: OrderedOutput.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  Reorder buffer for results computed out of order.  Each chunk of
+ *  output is numbered by its position in the input; chunks may be
+ *  completed in any order from any thread, and are written to the
+ *  output file (and their log text to std::cerr) strictly in number
+ *  order, as soon as all earlier chunks are done.
+ */
+
+#ifndef ORDERED_OUTPUT_HPP_
+#define ORDERED_OUTPUT_HPP_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+namespace hotspot
+{
+
+	class OrderedOutput
+	{
+	public:
+		/**
+		 * Prepare to write <numChunks> chunks to <fp>
+		 */
+		OrderedOutput( std::FILE* fp, int numChunks );
+		~OrderedOutput( );
+
+		/**
+		 * Hand over chunk number <chunk>.  <data> is written to the output file,
+		 * and <log> to std::cerr, once all lower-numbered chunks are written.
+		 * The contents of <data> and <log> are taken over, leaving them empty.
+		 */
+		void complete( int chunk, std::string& data, std::string& log );
+
+	private:
+		OrderedOutput( const OrderedOutput& );
+		OrderedOutput& operator=( const OrderedOutput& );
+
+		std::FILE* _fp;
+		pthread_mutex_t _lock;
+		std::vector< std::string* > _data;
+		std::vector< std::string* > _log;
+		int _nextChunk;
+	};
+
+} // namespace hotspot
+
+#endif /* ORDERED_OUTPUT_HPP_ */
@@ -0,0 +1,105 @@
+/**
+ * File: OutputBuffer.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  An implementation of OutputBuffer.hpp
+ */
+
+#include "OutputBuffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace hotspot
+{
+	// Values formatted directly by appendFixed( ) are below this once scaled
+	// to millionths, where the scaling is off by at most 2^-12
+	static const double FIXED_SCALED_LIMIT = 1099511627776.0; // 2^40
+
+	// Scaled values this close to halfway between two millionths are left to
+	// printf, which rounds them from the exact value
+	static const double FIXED_TIE_MARGIN = 1e-3;
+
+	/**
+	 * Write the digits of <value> backwards, ending at <end>.  Returns the
+	 * first digit.
+	 */
+	static char* UnsignedDigits( unsigned long long value, char* end )
+	{
+		do
+		{
+			*--end = '0' + static_cast< char >( value % 10 );
+			value /= 10;
+		} while( value > 0 );
+		return end;
+	}
+
+	void OutputBuffer::appendInt( long long value )
+	{
+		char digits[24];
+		char* end = digits + sizeof( digits );
+		unsigned long long magnitude = ( value < 0 ) ? 0ULL - static_cast< unsigned long long >( value )
+											   : static_cast< unsigned long long >( value );
+		char* first = UnsignedDigits( magnitude, end );
+		if( value < 0 )
+		{
+			*--first = '-';
+		}
+		_text.append( first, end );
+	}
+
+	void OutputBuffer::appendFixed( double value )
+	{
+		// printf rounds the exact value to six places, to even on a tie.  Away
+		// from a tie, rounding the scaled value gives the same millionths.
+		double scaled = std::fabs( value ) * 1e6;
+		if( scaled < FIXED_SCALED_LIMIT )
+		{
+			double whole = std::floor( scaled );
+			double fraction = scaled - whole;
+			if( std::fabs( fraction - 0.5 ) > FIXED_TIE_MARGIN )
+			{
+				unsigned long long millionths = static_cast< unsigned long long >( whole ) + ( fraction > 0.5 ? 1 : 0 );
+				char digits[32];
+				char* end = digits + sizeof( digits );
+				char* first = end;
+				unsigned long long places = millionths % 1000000;
+				for( int d = 0; d < 6; d++ )
+				{
+					*--first = '0' + static_cast< char >( places % 10 );
+					places /= 10;
+				}
+				*--first = '.';
+				first = UnsignedDigits( millionths / 1000000, first );
+				if( std::signbit( value ) )
+				{
+					*--first = '-';
+				}
+				_text.append( first, end );
+				return;
+			}
+		}
+
+		// Large values, ties, nan and inf
+		char text[512];
+		int length = std::snprintf( text, sizeof( text ), "%f", value );
+		_text.append( text, std::min( length, static_cast< int >( sizeof( text ) ) - 1 ) );
+	}
+
+	void OutputBuffer::appendExp( double value )
+	{
+		char text[64];
+		int length = std::snprintf( text, sizeof( text ), "%e", value );
+		_text.append( text, std::min( length, static_cast< int >( sizeof( text ) ) - 1 ) );
+	}
+
+	bool OutputBuffer::writeTo( std::FILE* fp )
+	{
+		bool written = _text.empty( ) || std::fwrite( _text.data( ), 1, _text.size( ), fp ) == _text.size( );
+		_text.clear( );
+		return written;
+	}
+}
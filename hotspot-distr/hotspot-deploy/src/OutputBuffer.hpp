@@ -0,0 +1,85 @@
+/**
+ * File: OutputBuffer.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  Text output gathered in memory and written in one piece.  Integers,
+ *  and most doubles, are formatted directly rather than by printf, but
+ *  read exactly as printf would write them.  The storage is kept when
+ *  the buffer is written, so one buffer can be reused for every
+ *  chromosome.
+ */
+
+#ifndef OUTPUT_BUFFER_HPP_
+#define OUTPUT_BUFFER_HPP_
+
+#include <cstdio>
+#include <string>
+
+namespace hotspot
+{
+
+	class OutputBuffer
+	{
+	public:
+		void append( char c )
+		{
+			_text += c;
+		}
+
+		void append( const char* text )
+		{
+			_text += text;
+		}
+
+		void append( const std::string& text )
+		{
+			_text += text;
+		}
+
+		/**
+		 * Append <value> as printf's %d would write it
+		 */
+		void appendInt( long long value );
+
+		/**
+		 * Append <value> as printf's %f would write it
+		 */
+		void appendFixed( double value );
+
+		/**
+		 * Append <value> as printf's %e would write it
+		 */
+		void appendExp( double value );
+
+		const char* c_str( ) const { return _text.c_str( ); }
+		std::string::size_type size( ) const { return _text.size( ); }
+
+		/**
+		 * Bytes allocated for the text, in use or kept for reuse
+		 */
+		std::string::size_type capacity( ) const { return _text.capacity( ); }
+
+		/**
+		 * Remove the text, keeping the storage for reuse
+		 */
+		void clear( )
+		{
+			_text.clear( );
+		}
+
+		/**
+		 * Write the text to <fp>, and clear it.  Returns false if it could
+		 * not all be written.
+		 */
+		bool writeTo( std::FILE* fp );
+
+	private:
+		std::string _text;
+	};
+
+} // namespace hotspot
+
+#endif /* OUTPUT_BUFFER_HPP_ */
@@ -0,0 +1,270 @@
+/**
+ * File: RandomLibGenerator.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  Entry point of hotspot-randlib, which writes a random tag library
+ *  (see RandomLibrary.hpp) in place of the shuffleBed, sort-bed and
+ *  starch steps of run_generate_random_lib.  Chromosomes are sampled
+ *  and formatted on a pool of threads, and written in name order, as
+ *  sort-bed orders them.  A text library gets a <lib>.counts file, as
+ *  the pipeline writes for real libraries.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "BinaryTagLibrary.hpp"
+#include "ByLine.hpp"
+#include "HotspotDefaults.hpp"
+#include "OrderedOutput.hpp"
+#include "RandomLibrary.hpp"
+#include "ThreadPool.hpp"
+
+namespace hotspot
+{
+	/**
+	 * Samples one chromosome, and for a text library formats it, too
+	 */
+	class ChromSampler : public ThreadPool::Task
+	{
+	public:
+		int chunk;
+		const MappableChrom* chrom;
+		long long numTags;
+		uint64_t seed;
+		bool noDup;
+		OrderedOutput* output; // NULL for a binary library, which is written afterward
+		std::vector< int > tags;
+		long long numWritten;
+
+		ChromSampler( ) : chunk( 0 ), chrom( NULL ), numTags( 0 ), seed( 0 ), noDup( false ), output( NULL ), numWritten( 0 ) { }
+
+		void run( )
+		{
+			SampleTags( *chrom, numTags, seed, tags );
+			if( noDup )
+			{
+				tags.erase( std::unique( tags.begin( ), tags.end( ) ), tags.end( ) );
+			}
+			numWritten = tags.size( );
+			if( output == NULL )
+			{
+				return;
+			}
+
+			std::string data;
+			data.reserve( tags.size( ) * ( chrom->name.size( ) + 12 ) );
+			char digits[16];
+			for( unsigned int i = 0; i < tags.size( ); i++ )
+			{
+				data += chrom->name;
+				data += ' ';
+				int n = 0;
+				unsigned int pos = tags[i];
+				do
+				{
+					digits[ n++ ] = '0' + pos % 10;
+					pos /= 10;
+				} while( pos > 0 );
+				while( n > 0 )
+				{
+					data += digits[ --n ];
+				}
+				data += '\n';
+			}
+			std::vector< int >( ).swap( tags );
+			std::string log;
+			output->complete( chunk, data, log );
+		}
+	};
+
+	bool byName( const MappableChrom& a, const MappableChrom& b )
+	{
+		return a.name < b.name;
+	}
+}
+
+int main( int argc, char **argv )
+{
+	std::string mappablePath, countsPath, chromsPath, outputPath;
+	long long numTags = -1;
+	uint64_t seed = hotspot::HotspotDefaults::RANDOM_LIB_SEED;
+	int numThreads = hotspot::HotspotDefaults::NUM_THREADS;
+	bool noDup = false;
+	bool binary = false;
+	for( int i = 1; i < argc; i++ )
+	{
+		bool hasValue = ( i + 1 < argc );
+		if( std::strcmp( argv[ i ], "-mappable" ) == 0 && hasValue )
+		{
+			mappablePath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-k" ) == 0 && hasValue )
+		{
+			countsPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-chroms" ) == 0 && hasValue )
+		{
+			chromsPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-n" ) == 0 && hasValue )
+		{
+			numTags = std::atoll( argv[ ++i ] );
+		}
+		else if( std::strcmp( argv[ i ], "-o" ) == 0 && hasValue )
+		{
+			outputPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-seed" ) == 0 && hasValue )
+		{
+			seed = std::strtoull( argv[ ++i ], NULL, 10 );
+		}
+		else if( std::strcmp( argv[ i ], "-threads" ) == 0 && hasValue )
+		{
+			numThreads = std::atoi( argv[ ++i ] );
+		}
+		else if( std::strcmp( argv[ i ], "-nodup" ) == 0 )
+		{
+			noDup = true;
+		}
+		else if( std::strcmp( argv[ i ], "-binary" ) == 0 )
+		{
+			binary = true;
+		}
+		else
+		{
+			std::cerr << "Unrecognized option: " << argv[ i ] << ". Aborting." << std::endl;
+			std::exit( EXIT_FAILURE );
+		}
+	}
+	if( mappablePath.empty( ) == countsPath.empty( ) || numTags < 0 || outputPath.empty( ) )
+	{
+		std::string msg  = "Usage: hotspot-randlib (-mappable <file-name> | -k <file-name>) -n <int> -o <file-name> [options]";
+		msg += "\n    -mappable <file-name> (uniquely mappable regions, sorted bed)";
+		msg += "\n    -k <file-name> (or: mappable counts in 10kb bins, as for hotspot -k)";
+		msg += "\n    -n <int> (number of tags)";
+		msg += "\n    -o <file-name> (output tag library)";
+		msg += "\n    -chroms <file-name> (only use the chromosomes listed in the first column)";
+		msg += "\n    -seed <int> (seed for the random number generator - default=1)";
+		msg += "\n    -threads <int> (number of threads - default=1)";
+		msg += "\n    -nodup (write each position at most once)";
+		msg += "\n    -binary (write a binary tag library, as hotspot-binlib does)";
+		msg += "\n";
+		std::cerr << msg << std::endl;
+		std::exit( EXIT_FAILURE );
+	}
+
+	std::vector< hotspot::MappableChrom > chroms;
+	bool ok = mappablePath.empty( )
+		? hotspot::ReadMappableCounts( countsPath, hotspot::HotspotDefaults::DENSITY_WIN_SMALL, chroms )
+		: hotspot::ReadMappableRegions( mappablePath, chroms );
+	if( ! ok )
+	{
+		std::exit( EXIT_FAILURE );
+	}
+	if( ! chromsPath.empty( ) )
+	{
+		std::ifstream in( chromsPath.c_str( ) );
+		if( ! in )
+		{
+			std::fprintf( stderr, "Error: unable to access %s\n", chromsPath.c_str( ) );
+			std::exit( EXIT_FAILURE );
+		}
+		std::set< std::string > names;
+		char name[ hotspot::HotspotDefaults::MAX_CHROM_NAME_LEN + 1 ];
+		ByLine line;
+		while( in >> line )
+		{
+			if( std::sscanf( line.c_str( ), "%127s", name ) == 1 )
+			{
+				names.insert( name );
+			}
+		}
+		unsigned int kept = 0;
+		for( unsigned int c = 0; c < chroms.size( ); c++ )
+		{
+			if( names.find( chroms[c].name ) != names.end( ) )
+			{
+				chroms[ kept++ ] = chroms[c];
+			}
+		}
+		chroms.resize( kept );
+	}
+	std::sort( chroms.begin( ), chroms.end( ), hotspot::byName );
+
+	std::vector< long long > counts;
+	hotspot::AllotTags( numTags, chroms, counts );
+
+	std::FILE* fp = std::fopen( outputPath.c_str( ), binary ? "wb" : "w" );
+	if( fp == NULL )
+	{
+		std::fprintf( stderr, "Error: unable to open %s: %s\n", outputPath.c_str( ), std::strerror( errno ) );
+		std::exit( EXIT_FAILURE );
+	}
+
+	std::vector< hotspot::ChromSampler > samplers( chroms.size( ) );
+	long long totalTags = 0;
+	{
+		hotspot::OrderedOutput output( fp, chroms.size( ) );
+		hotspot::ThreadPool pool( numThreads );
+		hotspot::ThreadPool::TaskGroup group;
+		for( unsigned int c = 0; c < chroms.size( ); c++ )
+		{
+			hotspot::ChromSampler& sampler = samplers[c];
+			sampler.chunk = c;
+			sampler.chrom = &chroms[c];
+			sampler.numTags = counts[c];
+			sampler.seed = seed;
+			sampler.noDup = noDup;
+			sampler.output = binary ? NULL : &output;
+			pool.submit( &sampler, group );
+		}
+		pool.wait( group );
+	}
+	for( unsigned int c = 0; c < samplers.size( ); c++ )
+	{
+		totalTags += samplers[c].numWritten;
+	}
+
+	if( binary )
+	{
+		hotspot::BinaryTagLibraryWriter writer( fp );
+		for( unsigned int c = 0; ok && c < samplers.size( ); c++ )
+		{
+			if( ! samplers[c].tags.empty( ) )
+			{
+				ok = writer.addChrom( chroms[c].name, samplers[c].tags );
+			}
+			std::vector< int >( ).swap( samplers[c].tags );
+		}
+		ok = ok && writer.finish( );
+	}
+	ok = ( std::fclose( fp ) == 0 ) && ok;
+	if( ok && ! binary )
+	{
+		std::string countsFileName = outputPath + ".counts";
+		std::FILE* cfp = std::fopen( countsFileName.c_str( ), "w" );
+		ok = cfp != NULL && std::fprintf( cfp, "%lld\n", totalTags ) > 0;
+		ok = ( cfp != NULL && std::fclose( cfp ) == 0 ) && ok;
+	}
+	if( ! ok )
+	{
+		std::fprintf( stderr, "Error: unable to write %s\n", outputPath.c_str( ) );
+		std::remove( outputPath.c_str( ) );
+		std::exit( EXIT_FAILURE );
+	}
+
+	std::cout << "TotalTagCount: " << totalTags << std::endl;
+	std::exit( EXIT_SUCCESS );
+}
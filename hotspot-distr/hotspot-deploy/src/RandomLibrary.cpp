@@ -0,0 +1,189 @@
+/**
+ * File: RandomLibrary.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  An implementation of RandomLibrary.hpp
+ */
+
+#include "RandomLibrary.hpp"
+#include "ByLine.hpp"
+#include "HotspotDefaults.hpp"
+#include "IntervalSet.hpp"
+#include "RandomStream.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+
+namespace hotspot
+{
+	/**
+	 * Makes a segment of each merged region of a BED file
+	 */
+	class MappableRegionCollector : public BedChromVisitor
+	{
+	public:
+		MappableRegionCollector( std::vector< MappableChrom >& chroms ) : _chroms( chroms ) { }
+
+		void visit( const std::string& chromName, IntervalSet& regions )
+		{
+			MappableChrom chrom;
+			chrom.name = chromName;
+			chrom.weight = 0;
+			const std::vector< Interval >& intervals = regions.intervals( );
+			chrom.segments.reserve( intervals.size( ) );
+			for( unsigned int i = 0; i < intervals.size( ); i++ )
+			{
+				MappableSegment segment;
+				segment.start = intervals[i].start;
+				segment.length = intervals[i].end - intervals[i].start;
+				segment.weight = segment.length;
+				chrom.segments.push_back( segment );
+				chrom.weight += segment.weight;
+			}
+			_chroms.push_back( chrom );
+		}
+
+	private:
+		std::vector< MappableChrom >& _chroms;
+	};
+
+	bool ReadMappableRegions( const std::string& fileName, std::vector< MappableChrom >& chroms )
+	{
+		MappableRegionCollector collector( chroms );
+		return ReadBedChroms( fileName, collector );
+	}
+
+	bool ReadMappableCounts( const std::string& fileName, int binSize, std::vector< MappableChrom >& chroms )
+	{
+		std::ifstream in( fileName.c_str( ) );
+		if( ! in )
+		{
+			std::fprintf( stderr, "Error: unable to access %s\n", fileName.c_str( ) );
+			return false;
+		}
+
+		char chromName[ HotspotDefaults::MAX_CHROM_NAME_LEN + 1 ];
+		int start, count;
+		int lineNum = 0;
+		ByLine line;
+		std::map< std::string, unsigned int > index;
+		MappableChrom* chrom = NULL;
+		while( in >> line )
+		{
+			lineNum++;
+			if( std::sscanf( line.c_str( ), "%127s %d %d", chromName, &start, &count ) != 3 )
+			{
+				std::fprintf( stderr, "Error: input file %s contains a malformed entry on line %d\n",
+						fileName.c_str( ), lineNum );
+				return false;
+			}
+			if( chrom == NULL || chrom->name != chromName )
+			{
+				if( index.find( chromName ) != index.end( ) )
+				{
+					std::fprintf( stderr, "Error: %s must be sorted; %s appears in more than one place\n",
+							fileName.c_str( ), chromName );
+					return false;
+				}
+				index[ chromName ] = chroms.size( );
+				chroms.push_back( MappableChrom( ) );
+				chrom = &chroms.back( );
+				chrom->name = chromName;
+				chrom->weight = 0;
+			}
+			MappableSegment segment;
+			segment.start = start;
+			segment.length = binSize;
+			segment.weight = count;
+			chrom->segments.push_back( segment );
+			chrom->weight += count;
+		}
+
+		// Shorten the last bins, and drop bins with nothing mappable
+		for( unsigned int c = 0; c < chroms.size( ); c++ )
+		{
+			std::vector< MappableSegment >& segments = chroms[c].segments;
+			segments.back( ).length = segments.back( ).weight;
+			unsigned int kept = 0;
+			for( unsigned int i = 0; i < segments.size( ); i++ )
+			{
+				if( segments[i].weight > 0 )
+				{
+					segments[ kept++ ] = segments[i];
+				}
+			}
+			segments.resize( kept );
+		}
+		return true;
+	}
+
+	void AllotTags( long long numTags, const std::vector< MappableChrom >& chroms, std::vector< long long >& counts )
+	{
+		long long totalWeight = 0;
+		for( unsigned int c = 0; c < chroms.size( ); c++ )
+		{
+			totalWeight += chroms[c].weight;
+		}
+		counts.assign( chroms.size( ), 0 );
+		if( totalWeight == 0 )
+		{
+			return;
+		}
+
+		// Whole shares first, then one more tag each for the largest remainders
+		std::vector< std::pair< long long, int > > remainders;
+		long long allotted = 0;
+		for( unsigned int c = 0; c < chroms.size( ); c++ )
+		{
+			long long share = numTags * chroms[c].weight;
+			counts[c] = share / totalWeight;
+			allotted += counts[c];
+			remainders.push_back( std::make_pair( -( share % totalWeight ), static_cast< int >( c ) ) );
+		}
+		std::sort( remainders.begin( ), remainders.end( ) );
+		for( unsigned int i = 0; allotted < numTags && i < remainders.size( ); i++, allotted++ )
+		{
+			counts[ remainders[i].second ]++;
+		}
+	}
+
+	void SampleTags( const MappableChrom& chrom, long long numTags, uint64_t seed, std::vector< int >& tags )
+	{
+		tags.resize( numTags );
+		if( numTags == 0 || chrom.weight == 0 )
+		{
+			tags.clear( );
+			return;
+		}
+
+		// The largest of i uniforms is distributed as U^(1/i), and the rest are
+		// uniform below it, so the order statistics can be drawn from the top
+		// down.  Each step multiplies by a factor of at most 1, so the
+		// positions come out sorted even with rounding.
+		RandomStream stream( seed, chrom.name );
+		double u = 1.0;
+		int s = chrom.segments.size( ) - 1;
+		long long segmentBase = chrom.weight - chrom.segments[s].weight;
+		for( long long i = numTags; i > 0; i-- )
+		{
+			u *= std::exp( std::log( 1.0 - stream.uniform( ) ) / i );
+			long long site = static_cast< long long >( u * chrom.weight );
+			if( site >= chrom.weight )
+			{
+				site = chrom.weight - 1;
+			}
+			while( site < segmentBase )
+			{
+				segmentBase -= chrom.segments[ --s ].weight;
+			}
+			const MappableSegment& segment = chrom.segments[s];
+			tags[ i - 1 ] = segment.start + static_cast< int >( ( site - segmentBase ) * segment.length / segment.weight );
+		}
+	}
+}
@@ -0,0 +1,75 @@
+/**
+ * File: RandomLibrary.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  Random tag libraries, with tags placed uniformly over the uniquely
+ *  mappable part of the genome, for estimating false discovery rates.
+ *  Tags are allotted to chromosomes in proportion to their mappable
+ *  bases, and each chromosome is sampled from its own random stream,
+ *  keyed by the seed and the chromosome name, so chromosomes can be
+ *  generated in any order, or at once, with the same result.  Tags are
+ *  drawn as sorted order statistics, so they never need sorting.
+ */
+
+#ifndef RANDOM_LIBRARY_HPP_
+#define RANDOM_LIBRARY_HPP_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace hotspot
+{
+
+	/**
+	 * A stretch of a chromosome holding <weight> mappable bases.  Tags that
+	 * fall in it are spread evenly over its <length> bases.
+	 */
+	struct MappableSegment
+	{
+		int start;
+		int length;
+		int weight;
+	};
+
+	struct MappableChrom
+	{
+		std::string name;
+		std::vector< MappableSegment > segments;
+		long long weight; // total over the segments
+	};
+
+	/**
+	 * Read the mappable regions of a BED file into <chroms>, one segment per
+	 * merged region.  Returns false, after reporting why, on error.
+	 */
+	bool ReadMappableRegions( const std::string& fileName, std::vector< MappableChrom >& chroms );
+
+	/**
+	 * Read a mappable counts file (<chrom> <bin start> <mappable bases>, as
+	 * written by run_10kb_counts) into <chroms>, one segment per bin of
+	 * <binSize> bases.  The mappable bases of a bin are not known exactly, so
+	 * its tags are spread over the whole bin; the last bin of a chromosome,
+	 * which may be short, is taken to be only as long as its mappable bases.
+	 * Returns false, after reporting why, on error.
+	 */
+	bool ReadMappableCounts( const std::string& fileName, int binSize, std::vector< MappableChrom >& chroms );
+
+	/**
+	 * Divide <numTags> among <chroms> in proportion to their weight, rounding
+	 * so that the counts sum to <numTags> (largest remainders first)
+	 */
+	void AllotTags( long long numTags, const std::vector< MappableChrom >& chroms, std::vector< long long >& counts );
+
+	/**
+	 * Draw <numTags> positions uniformly, with replacement, over the mappable
+	 * bases of <chrom>, in sorted order, into <tags>
+	 */
+	void SampleTags( const MappableChrom& chrom, long long numTags, uint64_t seed, std::vector< int >& tags );
+
+} // namespace hotspot
+
+#endif /* RANDOM_LIBRARY_HPP_ */
@@ -0,0 +1,75 @@
+/**
+ * File: RandomStream.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  A small, fast pseudo-random number stream (SplitMix64).  Unlike
+ *  std::rand( ), each stream has its own state, so independent streams
+ *  can be used from different threads, and each is reproducible from
+ *  its seed alone.  Streams for different keys, such as chromosome
+ *  names, are made by mixing a hash of the key into the seed.
+ */
+
+#ifndef RANDOM_STREAM_HPP_
+#define RANDOM_STREAM_HPP_
+
+#include <string>
+#include <stdint.h>
+
+namespace hotspot
+{
+
+	class RandomStream
+	{
+	public:
+		RandomStream( uint64_t seed ) : _state( seed ) { }
+
+		/**
+		 * The stream for <key> under <seed>
+		 */
+		RandomStream( uint64_t seed, const std::string& key ) : _state( seed )
+		{
+			_state = next( ) ^ hash( key );
+		}
+
+		/**
+		 * Next 64 random bits
+		 */
+		uint64_t next( )
+		{
+			uint64_t z = ( _state += 0x9E3779B97F4A7C15ULL );
+			z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+			z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+			return z ^ ( z >> 31 );
+		}
+
+		/**
+		 * Uniform on [0, 1), with 53 random bits
+		 */
+		double uniform( )
+		{
+			return ( next( ) >> 11 ) * ( 1.0 / 9007199254740992.0 );
+		}
+
+		/**
+		 * 64-bit FNV-1a hash of <key>
+		 */
+		static uint64_t hash( const std::string& key )
+		{
+			uint64_t h = 0xCBF29CE484222325ULL;
+			for( std::string::size_type i = 0; i < key.size( ); i++ )
+			{
+				h = ( h ^ static_cast< unsigned char >( key[i] ) ) * 0x100000001B3ULL;
+			}
+			return h;
+		}
+
+	private:
+		uint64_t _state;
+	};
+
+} // namespace hotspot
+
+#endif /* RANDOM_STREAM_HPP_ */
@@ -0,0 +1,477 @@
+/**
+ * File: Rescore.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  An implementation of Rescore.hpp.  The hotspots of both passes are
+ *  read first, and everything else is counted against them a
+ *  chromosome at a time: tags by binary search in sorted tag vectors,
+ *  mappable bases by IntervalSet::coverage( ) while each BED file is
+ *  streamed past.  Chromosomes are then scored on a thread pool.  For
+ *  SPOT, the library is read last, and each chromosome's tags are swept
+ *  once through the merged hotspots of each pass and of both.
+ */
+
+#include "Rescore.hpp"
+#include "Binomial.hpp"
+#include "ByLine.hpp"
+#include "HotspotDefaults.hpp"
+#include "InputDataReader.hpp"
+#include "IntervalSet.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <vector>
+
+namespace hotspot
+{
+	/**
+	 * One hotspot to re-score, with its counts
+	 */
+	struct RescoreHotspot
+	{
+		int left;   // region scored: the hotspot's window, centered on its position
+		int right;
+		int start;  // region reported: its outermost tags
+		int end;
+		int count;  // tags in the hotspot
+		int inputTags;
+		long long leftBases;  // background mappable bases in each flank
+		long long rightBases;
+		long long bases;      // mappable bases in [left, right)
+		int pass;             // 0 for pass 1, 1 for pass 2
+	};
+
+	/**
+	 * A re-scored hotspot, ready to merge
+	 */
+	struct ScoredHotspot
+	{
+		int start;
+		int end;
+		double zScore;
+		double pValue;
+
+		bool operator<( const ScoredHotspot& other ) const
+		{
+			return start < other.start || ( start == other.start && end < other.end );
+		}
+	};
+
+	/**
+	 * The hotspots of one chromosome, and the background tags around them
+	 */
+	class RescoreChrom : public ThreadPool::Task
+	{
+	public:
+		std::string chromName;
+		std::vector< RescoreHotspot > hotspots;
+		std::vector< int > backgroundTags;
+		const RescoreParams* params;
+		double inputScale; // input tags are scaled by this before subtraction; 0 for no input
+		std::string zscores; // formatted output
+		std::string pvals;
+		IntervalSet spotRegions[3]; // for SPOT: the scored hotspots of pass 1, pass 2 and both
+
+		RescoreChrom( ) : params( NULL ), inputScale( 0 ) { }
+
+		void run( );
+
+	private:
+		int countTags( int start, int end ) const
+		{
+			return std::lower_bound( backgroundTags.begin( ), backgroundTags.end( ), end )
+				- std::lower_bound( backgroundTags.begin( ), backgroundTags.end( ), start );
+		}
+	};
+
+	/**
+	 * <x> to the <digits> significant digits it is written out with between
+	 * the steps of run_rescore_hotspot_passes; awk writes integers in full
+	 */
+	static double AsWritten( double x, int digits )
+	{
+		if( x == std::floor( x ) && std::fabs( x ) < 1e15 )
+		{
+			return x;
+		}
+		char text[64];
+		std::snprintf( text, sizeof( text ), "%.*g", digits, x );
+		return std::strtod( text, NULL );
+	}
+
+	void RescoreChrom::run( )
+	{
+		std::sort( backgroundTags.begin( ), backgroundTags.end( ) );
+		int flank = params->densityWin / 2;
+		double numTags = params->numTags;
+		std::vector< ScoredHotspot > scored;
+		for( unsigned int i = 0; i < hotspots.size( ); i++ )
+		{
+			const RescoreHotspot& h = hotspots[i];
+			int count = h.count;
+			if( inputScale > 0 )
+			{
+				count = static_cast< int >( count - h.inputTags * inputScale );
+				if( count < 0 )
+				{
+					count = 0;
+				}
+			}
+
+			// Local background: the flanks.  Input tags are not subtracted
+			// there, which keeps the z-score conservative.
+			int flankTags = countTags( std::max( h.left - flank, 0 ), h.left ) + countTags( h.right, h.right + flank );
+			double flankBases = static_cast< double >( h.leftBases + h.rightBases + h.bases );
+			double p = ( flankBases == 0 ) ? 0 : h.bases / flankBases;
+			double n = count + flankTags;
+			double sd = std::pow( n * p * ( 1 - p ), .5 );
+
+			// Genome-wide background
+			double pgw = h.bases / params->mappableGenomeSize;
+			double sdgw = std::pow( numTags * pgw * ( 1 - pgw ), .5 );
+			if( sd == 0 || sdgw == 0 )
+			{
+				continue;
+			}
+			double z = ( count - n * p ) / sd;
+			double zgw = ( count - numTags * pgw ) / sdgw;
+
+			ScoredHotspot s;
+			s.start = h.start;
+			s.end = h.end;
+			s.zScore = AsWritten( std::min( z, zgw ), 6 );
+			// The p-values are computed from probabilities as written for R
+			double pValue = BinomialUpperTail( count, n, AsWritten( p, 6 ) );
+			double pValueGW = BinomialUpperTail( count, numTags, AsWritten( pgw, 6 ) );
+			s.pValue = AsWritten( std::max( pValue, pValueGW ), 7 );
+			scored.push_back( s );
+			if( ! params->spotTagsFileName.empty( ) )
+			{
+				spotRegions[ h.pass ].add( h.start, h.end );
+				spotRegions[2].add( h.start, h.end );
+			}
+		}
+		for( int k = 0; k < 3; k++ )
+		{
+			spotRegions[k].merge( );
+		}
+
+		// Merge overlapping and adjoining hotspots
+		std::sort( scored.begin( ), scored.end( ) );
+		char line[ HotspotDefaults::MAX_CHROM_NAME_LEN + 128 ];
+		unsigned int i = 0;
+		while( i < scored.size( ) )
+		{
+			int start = scored[i].start;
+			int end = scored[i].end;
+			double zScore = scored[i].zScore;
+			double pValue = scored[i].pValue;
+			for( i++; i < scored.size( ) && scored[i].start <= end; i++ )
+			{
+				end = std::max( end, scored[i].end );
+				zScore = std::max( zScore, scored[i].zScore );
+				pValue = std::min( pValue, scored[i].pValue );
+			}
+			std::snprintf( line, sizeof( line ), "%s\t%d\t%d\t%f\n", chromName.c_str( ), start, end, zScore );
+			zscores += line;
+			std::snprintf( line, sizeof( line ), "%e\n", pValue );
+			pvals += line;
+		}
+		std::vector< int >( ).swap( backgroundTags );
+	}
+
+	/**
+	 * Counts the mappable bases in each hotspot, or in its flanks, a chromosome
+	 * at a time
+	 */
+	class MappableBasesCounter : public BedChromVisitor
+	{
+	public:
+		MappableBasesCounter( std::map< std::string, RescoreChrom* >& chroms, bool flanks, int flank )
+			: _chroms( chroms ), _flanks( flanks ), _flank( flank ) { }
+
+		void visit( const std::string& chromName, IntervalSet& regions )
+		{
+			std::map< std::string, RescoreChrom* >::iterator chrom = _chroms.find( chromName );
+			if( chrom == _chroms.end( ) )
+			{
+				return;
+			}
+			std::vector< RescoreHotspot >& hotspots = chrom->second->hotspots;
+			for( unsigned int i = 0; i < hotspots.size( ); i++ )
+			{
+				RescoreHotspot& h = hotspots[i];
+				if( _flanks )
+				{
+					h.leftBases = regions.coverage( std::max( h.left - _flank, 0 ), h.left );
+					h.rightBases = regions.coverage( h.right, h.right + _flank );
+				}
+				else
+				{
+					h.bases = regions.coverage( h.left, h.right );
+				}
+			}
+		}
+
+	private:
+		std::map< std::string, RescoreChrom* >& _chroms;
+		bool _flanks;
+		int _flank;
+	};
+
+	/**
+	 * Add the hotspots of the hotspot output file <fileName> that are at least
+	 * minSize wide, with a finite z-score above zThresh, to <chroms>
+	 */
+	static bool ReadHotspots( const std::string& fileName, int pass, const RescoreParams& params,
+							  std::map< std::string, RescoreChrom* >& chroms )
+	{
+		std::ifstream in( fileName.c_str( ) );
+		if( ! in )
+		{
+			std::fprintf( stderr, "Error: unable to access %s\n", fileName.c_str( ) );
+			return false;
+		}
+
+		int nameStart, nameEnd, pos, size, dist, minSite, maxSite;
+		double width, z;
+		int lineNum = 0;
+		ByLine line;
+		while( in >> line )
+		{
+			if( ++lineNum == 1 )
+			{
+				continue; // header
+			}
+			// The name is located rather than copied, so it has no length limit
+			if( std::sscanf( line.c_str( ), " %n%*s%n %d %d %d %lf %d %d %lf", &nameStart, &nameEnd,
+							 &pos, &size, &dist, &width, &minSite, &maxSite, &z ) != 7 )
+			{
+				std::fprintf( stderr, "Error: input file %s contains a malformed entry on line %d\n",
+						fileName.c_str( ), lineNum );
+				return false;
+			}
+			if( maxSite - minSite + 1 < params.minSize || ! ( z > params.zThresh ) || std::isinf( z ) )
+			{
+				continue;
+			}
+
+			std::string chromName( line, nameStart, nameEnd - nameStart );
+			RescoreChrom*& chrom = chroms[ chromName ];
+			if( chrom == NULL )
+			{
+				chrom = new RescoreChrom;
+				chrom->chromName = chromName;
+				chrom->params = &params;
+			}
+			RescoreHotspot h;
+			int pad = static_cast< int >( .5 + width / 2 );
+			h.left = std::max( pos - pad, 0 );
+			h.right = pos + pad;
+			h.start = minSite;
+			h.end = maxSite + 1;
+			h.count = size;
+			h.inputTags = 0;
+			h.leftBases = 0;
+			h.rightBases = 0;
+			h.bases = 0;
+			h.pass = pass;
+			chrom->hotspots.push_back( h );
+		}
+		return true;
+	}
+
+	/**
+	 * Read the library <fileName>, keeping the tags of chromosomes in <chroms>
+	 * as background tags, or, for <input> tags, counting those in each hotspot.
+	 * <numTags> is set to the number of tags in the library.
+	 */
+	static bool ReadTags( const std::string& fileName, std::map< std::string, RescoreChrom* >& chroms,
+						  bool input, int& numTags )
+	{
+		InputDataReader reader( fileName );
+		std::vector< int > tags;
+		int numRead;
+		numTags = 0;
+		while( ( numRead = reader.readNextChrom( tags ) ) > 0 )
+		{
+			numTags += numRead;
+			std::map< std::string, RescoreChrom* >::iterator chrom = chroms.find( reader.currentChromName( ) );
+			if( chrom != chroms.end( ) && ! input )
+			{
+				chrom->second->backgroundTags.insert( chrom->second->backgroundTags.end( ), tags.begin( ), tags.end( ) );
+			}
+			else if( chrom != chroms.end( ) )
+			{
+				std::sort( tags.begin( ), tags.end( ) );
+				std::vector< RescoreHotspot >& hotspots = chrom->second->hotspots;
+				for( unsigned int i = 0; i < hotspots.size( ); i++ )
+				{
+					hotspots[i].inputTags += std::lower_bound( tags.begin( ), tags.end( ), hotspots[i].right )
+						- std::lower_bound( tags.begin( ), tags.end( ), hotspots[i].left );
+				}
+			}
+			tags.clear( );
+		}
+		return numRead == 0;
+	}
+
+	/**
+	 * Tags of a chromosome, or of the genome, and those in the hotspots of
+	 * pass 1, pass 2 and both
+	 */
+	struct SpotCounts
+	{
+		long long tags;
+		long long inHotspots[3];
+
+		SpotCounts( ) : tags( 0 )
+		{
+			inHotspots[0] = inHotspots[1] = inHotspots[2] = 0;
+		}
+	};
+
+	static void WriteSpotRow( std::FILE* fp, const std::string& name, const SpotCounts& counts )
+	{
+		std::fprintf( fp, "%s\t%lld", name.c_str( ), counts.tags );
+		for( int k = 0; k < 3; k++ )
+		{
+			std::fprintf( fp, "\t%lld", counts.inHotspots[k] );
+		}
+		for( int k = 0; k < 3; k++ )
+		{
+			std::fprintf( fp, "\t%f", counts.tags == 0 ? 0.0 : static_cast< double >( counts.inHotspots[k] ) / counts.tags );
+		}
+		std::fprintf( fp, "\n" );
+	}
+
+	/**
+	 * Count the tags of the library <fileName> in the scored hotspots of
+	 * <chroms>, and write the SPOT table of RescoreHotspots( ) to <fp>
+	 */
+	static bool WriteSpot( const std::string& fileName, const std::map< std::string, RescoreChrom* >& chroms,
+						   std::FILE* fp )
+	{
+		// Sorted by name, as sort-bed orders chromosomes
+		std::map< std::string, SpotCounts > counts;
+		SpotCounts total;
+		InputDataReader reader( fileName );
+		std::vector< int > tags;
+		std::vector< std::pair< int, int > > ranges;
+		int numRead;
+		while( ( numRead = reader.readNextChrom( tags ) ) > 0 )
+		{
+			SpotCounts& c = counts[ reader.currentChromName( ) ];
+			c.tags += numRead;
+			total.tags += numRead;
+			std::map< std::string, RescoreChrom* >::const_iterator chrom = chroms.find( reader.currentChromName( ) );
+			if( chrom != chroms.end( ) )
+			{
+				std::sort( tags.begin( ), tags.end( ) );
+				for( int k = 0; k < 3; k++ )
+				{
+					ranges.clear( );
+					chrom->second->spotRegions[k].selectTags( tags, ranges );
+					for( unsigned int r = 0; r < ranges.size( ); r++ )
+					{
+						c.inHotspots[k] += ranges[r].second - ranges[r].first;
+						total.inHotspots[k] += ranges[r].second - ranges[r].first;
+					}
+				}
+			}
+			tags.clear( );
+		}
+		if( numRead < 0 )
+		{
+			return false;
+		}
+
+		std::fprintf( fp, "Chrom\tTags\tPass1Tags\tPass2Tags\tTwoPassTags\tPass1SPOT\tPass2SPOT\tTwoPassSPOT\n" );
+		for( std::map< std::string, SpotCounts >::const_iterator c = counts.begin( ); c != counts.end( ); ++c )
+		{
+			WriteSpotRow( fp, c->first, c->second );
+		}
+		WriteSpotRow( fp, "all", total );
+		return true;
+	}
+
+	bool RescoreHotspots( const RescoreParams& params, std::FILE* zscoreOut, std::FILE* pvalOut,
+						  std::FILE* spotOut )
+	{
+		// Sorted by name, as sort-bed orders chromosomes
+		std::map< std::string, RescoreChrom* > chroms;
+		std::map< std::string, RescoreChrom* >::iterator chrom;
+		bool ok = true;
+
+		std::cerr << "Reading hotspots" << std::endl;
+		ok = ok && ReadHotspots( params.passOneFileName, 0, params, chroms );
+		ok = ok && ReadHotspots( params.passTwoFileName, 1, params, chroms );
+
+		std::cerr << "Counting background tags and mappable bases" << std::endl;
+		int numBackgroundTags = 0;
+		ok = ok && ReadTags( params.backgroundTagsFileName, chroms, false, numBackgroundTags );
+		MappableBasesCounter flankCounter( chroms, true, params.densityWin / 2 );
+		ok = ok && ReadBedChroms( params.backgroundRegionsFileName, flankCounter );
+		MappableBasesCounter hotspotCounter( chroms, false, 0 );
+		ok = ok && ReadBedChroms( params.mappableRegionsFileName, hotspotCounter );
+
+		// Input tags are scaled to the library size, truncated to 5 decimal
+		// places as bc computes it
+		double inputScale = 0;
+		if( ok && ! params.inputTagsFileName.empty( ) )
+		{
+			std::cerr << "Counting input tags" << std::endl;
+			int numInputTags = 0;
+			ok = ReadTags( params.inputTagsFileName, chroms, true, numInputTags );
+			if( ok && numInputTags == 0 )
+			{
+				std::fprintf( stderr, "Error: no input tags in %s\n", params.inputTagsFileName.c_str( ) );
+				ok = false;
+			}
+			if( ok )
+			{
+				inputScale = ( static_cast< long long >( params.numTags ) * 100000 / numInputTags ) / 100000.0;
+			}
+		}
+
+		if( ok )
+		{
+			std::cerr << "Scoring hotspots" << std::endl;
+			ThreadPool pool( params.numThreads );
+			ThreadPool::TaskGroup group;
+			for( chrom = chroms.begin( ); chrom != chroms.end( ); ++chrom )
+			{
+				chrom->second->inputScale = inputScale;
+				pool.submit( chrom->second, group );
+			}
+			pool.wait( group );
+
+			std::fprintf( zscoreOut, "track type=wiggle_0 visibility=full name=%s\n", params.trackName.c_str( ) );
+			for( chrom = chroms.begin( ); chrom != chroms.end( ); ++chrom )
+			{
+				std::fputs( chrom->second->zscores.c_str( ), zscoreOut );
+				std::fputs( chrom->second->pvals.c_str( ), pvalOut );
+			}
+		}
+
+		if( ok && ! params.spotTagsFileName.empty( ) )
+		{
+			std::cerr << "Counting tags in hotspots for SPOT" << std::endl;
+			ok = WriteSpot( params.spotTagsFileName, chroms, spotOut );
+		}
+
+		for( chrom = chroms.begin( ); chrom != chroms.end( ); ++chrom )
+		{
+			delete chrom->second;
+		}
+		return ok;
+	}
+}
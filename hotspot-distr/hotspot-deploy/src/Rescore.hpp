@@ -0,0 +1,65 @@
+/**
+ * File: Rescore.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  Re-score the hotspots of both passes against the pass-2 background,
+ *  as run_rescore_hotspot_passes does with bedmap, awk and R.  Each
+ *  hotspot, centered on its position and as wide as its window, is
+ *  scored against the background tags and background mappable bases in
+ *  half a density window on either side, and against the genome as a
+ *  whole; the lower z-score, and the higher binomial p-value, are kept.
+ *  Overlapping hotspots are then merged, keeping the highest z-score and
+ *  lowest p-value, and written as the twopass.zscore.wig and pval.txt
+ *  files of the pipeline.
+ *
+ *  The SPOT score (signal portion of tags) can be worked out in the same
+ *  run, in place of the run_spot pass over the whole tag file: the tags of
+ *  the library that fall in the hotspots of pass 1, of pass 2, and of both
+ *  merged, a chromosome at a time and genome-wide.
+ */
+
+#ifndef RESCORE_HPP_
+#define RESCORE_HPP_
+
+#include <cstdio>
+#include <string>
+
+namespace hotspot
+{
+
+	struct RescoreParams
+	{
+		std::string passOneFileName;   // hotspot output of each pass
+		std::string passTwoFileName;
+		std::string backgroundTagsFileName;    // tags of the pass-2 background, a library file
+		std::string backgroundRegionsFileName; // the pass-2 background regions, BED
+		std::string mappableRegionsFileName;   // uniquely mappable regions, BED
+		std::string inputTagsFileName; // ChIP-seq input tags to subtract, a library file; empty for none
+		std::string spotTagsFileName;  // the library, whose tags in the hotspots give SPOT; empty for none
+		std::string trackName;         // name in the z-score track line
+		int minSize;       // hotspots narrower than this are not scored
+		double zThresh;    // nor those with a z-score no higher than this
+		int densityWin;    // flanks are half this wide
+		int numTags;       // tags in the library, for the genome-wide background
+		double mappableGenomeSize;
+		int numThreads;
+	};
+
+	/**
+	 * Re-score the hotspots of <params>, and write the merged z-scores to
+	 * <zscoreOut>, and their p-values to <pvalOut>.  With a spotTagsFileName,
+	 * the SPOT table is written to <spotOut>: a header, then one row per
+	 * chromosome of the library and a last one, "all", for the genome, each
+	 * with its tags, those in the hotspots of pass 1, pass 2 and both, and
+	 * the share of the tags those are.  Returns false, after reporting why,
+	 * if an input cannot be read.
+	 */
+	bool RescoreHotspots( const RescoreParams& params, std::FILE* zscoreOut, std::FILE* pvalOut,
+						  std::FILE* spotOut );
+
+} // namespace hotspot
+
+#endif /* RESCORE_HPP_ */
@@ -0,0 +1,245 @@
+/**
+ * File: RunStats.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  An implementation of RunStats.hpp
+ */
+
+#include "RunStats.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <sys/resource.h>
+
+namespace hotspot
+{
+	static const char* STAGE_NAMES[ NUM_RUN_STAGES ] = { "read", "sweep", "filter", "cluster", "write" };
+
+	static double Seconds( clockid_t clock )
+	{
+		struct timespec now;
+		clock_gettime( clock, &now );
+		return now.tv_sec + now.tv_nsec * 1e-9;
+	}
+
+	static double Seconds( const struct timeval& t )
+	{
+		return t.tv_sec + t.tv_usec * 1e-6;
+	}
+
+	ChromStats::ChromStats( ) : library( 0 ), pass( 1 ), order( 0 ), tags( 0 ), candidates( 0 ), hotspots( 0 )
+	{
+		for( int s = 0; s < NUM_RUN_STAGES; s++ )
+		{
+			stages[s].wall = 0.0;
+			stages[s].cpu = 0.0;
+		}
+	}
+
+	StageClock::StageClock( ChromStats* stats ) : _stats( stats ), _wall( 0.0 ), _cpu( 0.0 )
+	{
+		start( );
+	}
+
+	void StageClock::start( )
+	{
+		if( _stats != NULL )
+		{
+			_wall = Seconds( CLOCK_MONOTONIC );
+			_cpu = Seconds( CLOCK_THREAD_CPUTIME_ID );
+		}
+	}
+
+	void StageClock::lap( RunStage stage )
+	{
+		if( _stats == NULL )
+		{
+			return;
+		}
+		double wall = Seconds( CLOCK_MONOTONIC );
+		double cpu = Seconds( CLOCK_THREAD_CPUTIME_ID );
+		_stats->stages[ stage ].wall += wall - _wall;
+		_stats->stages[ stage ].cpu += cpu - _cpu;
+		_wall = wall;
+		_cpu = cpu;
+	}
+
+	RunStats::RunStats( int argc, char** argv ) : _startWall( Seconds( CLOCK_MONOTONIC ) ), _arenaBytes( 0 )
+	{
+		for( int i = 0; i < argc; i++ )
+		{
+			_command += ( i > 0 ) ? " " : "";
+			_command += argv[i];
+		}
+		pthread_mutex_init( &_lock, NULL );
+	}
+
+	RunStats::~RunStats( )
+	{
+		pthread_mutex_destroy( &_lock );
+	}
+
+	void RunStats::addChrom( const ChromStats& chrom )
+	{
+		pthread_mutex_lock( &_lock );
+		_chroms.push_back( chrom );
+		pthread_mutex_unlock( &_lock );
+	}
+
+	void RunStats::addInput( const std::string& path, long long bytes, long long lines )
+	{
+		InputStats input;
+		input.path = path;
+		input.bytes = bytes;
+		input.lines = lines;
+		pthread_mutex_lock( &_lock );
+		_inputs.push_back( input );
+		pthread_mutex_unlock( &_lock );
+	}
+
+	void RunStats::noteArenaBytes( long long bytes )
+	{
+		pthread_mutex_lock( &_lock );
+		_arenaBytes = std::max( _arenaBytes, bytes );
+		pthread_mutex_unlock( &_lock );
+	}
+
+	// Chromosomes in the order they were read: by library, pass and position
+	static bool readFirst( const ChromStats& a, const ChromStats& b )
+	{
+		if( a.library != b.library )
+		{
+			return a.library < b.library;
+		}
+		if( a.pass != b.pass )
+		{
+			return a.pass < b.pass;
+		}
+		return a.order < b.order;
+	}
+
+	/**
+	 * Write <text> as a JSON string
+	 */
+	static void PrintString( std::FILE* fp, const std::string& text )
+	{
+		std::fputc( '"', fp );
+		for( std::string::size_type i = 0; i < text.size( ); i++ )
+		{
+			unsigned char c = text[i];
+			if( c == '"' || c == '\\' )
+			{
+				std::fprintf( fp, "\\%c", c );
+			}
+			else if( c < 0x20 )
+			{
+				std::fprintf( fp, "\\u%04x", c );
+			}
+			else
+			{
+				std::fputc( c, fp );
+			}
+		}
+		std::fputc( '"', fp );
+	}
+
+	static void PrintStages( std::FILE* fp, const StageTime* stages, const char* indent )
+	{
+		for( int s = 0; s < NUM_RUN_STAGES; s++ )
+		{
+			std::fprintf( fp, "%s\"%s\": { \"wall_seconds\": %.6f, \"cpu_seconds\": %.6f }%s\n", indent,
+						  STAGE_NAMES[s], stages[s].wall, stages[s].cpu, ( s + 1 < NUM_RUN_STAGES ) ? "," : "" );
+		}
+	}
+
+	bool RunStats::write( const std::string& fileName, int numThreads ) const
+	{
+		double wall = Seconds( CLOCK_MONOTONIC ) - _startWall;
+		struct rusage usage;
+		getrusage( RUSAGE_SELF, &usage );
+
+		std::FILE* fp = std::fopen( fileName.c_str( ), "w" );
+		if( fp == NULL )
+		{
+			std::fprintf( stderr, "Error: unable to write %s\n", fileName.c_str( ) );
+			return false;
+		}
+
+		std::vector< ChromStats > chroms( _chroms );
+		std::stable_sort( chroms.begin( ), chroms.end( ), readFirst );
+		StageTime stages[ NUM_RUN_STAGES ];
+		long long candidates = 0;
+		long long hotspots = 0;
+		std::vector< long long > libraryTags( _inputs.size( ), 0 );
+		for( int s = 0; s < NUM_RUN_STAGES; s++ )
+		{
+			stages[s].wall = 0.0;
+			stages[s].cpu = 0.0;
+		}
+		for( unsigned int c = 0; c < chroms.size( ); c++ )
+		{
+			for( int s = 0; s < NUM_RUN_STAGES; s++ )
+			{
+				stages[s].wall += chroms[c].stages[s].wall;
+				stages[s].cpu += chroms[c].stages[s].cpu;
+			}
+			candidates += chroms[c].candidates;
+			hotspots += chroms[c].hotspots;
+			if( chroms[c].pass == 1 && chroms[c].library < static_cast< int >( libraryTags.size( ) ) )
+			{
+				libraryTags[ chroms[c].library ] += chroms[c].tags;
+			}
+		}
+
+		std::fprintf( fp, "{\n  \"command\": " );
+		PrintString( fp, _command );
+		std::fprintf( fp, ",\n  \"threads\": %d,\n", numThreads );
+		std::fprintf( fp, "  \"wall_seconds\": %.6f,\n", wall );
+		std::fprintf( fp, "  \"user_seconds\": %.6f,\n", Seconds( usage.ru_utime ) );
+		std::fprintf( fp, "  \"system_seconds\": %.6f,\n", Seconds( usage.ru_stime ) );
+		std::fprintf( fp, "  \"peak_rss_bytes\": %lld,\n", static_cast< long long >( usage.ru_maxrss ) * 1024 );
+		std::fprintf( fp, "  \"hotspot_table_peak_bytes\": %lld,\n", _arenaBytes );
+		std::fprintf( fp, "  \"candidates\": %lld,\n", candidates );
+		std::fprintf( fp, "  \"hotspots\": %lld,\n", hotspots );
+
+		std::fprintf( fp, "  \"inputs\": [" );
+		for( unsigned int i = 0; i < _inputs.size( ); i++ )
+		{
+			std::fprintf( fp, "%s\n    { \"path\": ", ( i > 0 ) ? "," : "" );
+			PrintString( fp, _inputs[i].path );
+			std::fprintf( fp, ", \"bytes\": %lld, \"lines\": %lld, \"tags\": %lld }",
+						  _inputs[i].bytes, _inputs[i].lines, libraryTags[i] );
+		}
+		std::fprintf( fp, "%s],\n", _inputs.empty( ) ? "" : "\n  " );
+
+		std::fprintf( fp, "  \"stages\": {\n" );
+		PrintStages( fp, stages, "    " );
+		std::fprintf( fp, "  },\n" );
+
+		std::fprintf( fp, "  \"chroms\": [" );
+		for( unsigned int c = 0; c < chroms.size( ); c++ )
+		{
+			const ChromStats& chrom = chroms[c];
+			std::fprintf( fp, "%s\n    {\n      \"library\": %d,\n      \"pass\": %d,\n      \"chrom\": ",
+						  ( c > 0 ) ? "," : "", chrom.library, chrom.pass );
+			PrintString( fp, chrom.chrom );
+			std::fprintf( fp, ",\n      \"tags\": %lld,\n      \"candidates\": %lld,\n      \"hotspots\": %lld,\n",
+						  chrom.tags, chrom.candidates, chrom.hotspots );
+			std::fprintf( fp, "      \"stages\": {\n" );
+			PrintStages( fp, chrom.stages, "        " );
+			std::fprintf( fp, "      }\n    }" );
+		}
+		std::fprintf( fp, "%s]\n}\n", chroms.empty( ) ? "" : "\n  " );
+
+		if( std::fclose( fp ) != 0 )
+		{
+			std::fprintf( stderr, "Error: unable to write %s\n", fileName.c_str( ) );
+			return false;
+		}
+		return true;
+	}
+}
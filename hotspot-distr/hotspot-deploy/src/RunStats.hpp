@@ -0,0 +1,144 @@
+/**
+ * File: RunStats.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  The -stats run report: wall and CPU time of each stage of each
+ *  chromosome, the input bytes and lines parsed, the candidates and
+ *  hotspots found, and the memory high-water marks, written as JSON.
+ *  Each stage is timed once per chromosome (once per chunk when the
+ *  library is streamed), so collecting the report costs a few clock
+ *  reads per chromosome, and it can be left on.
+ *
+ *  CPU time is that of the thread that ran the stage; window sizes swept
+ *  by other threads in -threads mode show only in the run's totals.  A
+ *  streamed library clusters its candidates as they are found, so its
+ *  filtering counts as part of the sweep, and dropping spent tags as part
+ *  of reading.  Tags in pass 2 of -twopass are taken from those of pass 1,
+ *  which counts as its reading.
+ */
+
+#ifndef RUN_STATS_HPP_
+#define RUN_STATS_HPP_
+
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+namespace hotspot
+{
+
+	enum RunStage
+	{
+		STAGE_READ,    // parsing the tags, and reading the background counts
+		STAGE_SWEEP,   // ComputeHotSpots
+		STAGE_FILTER,  // FilterHotspots
+		STAGE_CLUSTER, // ClusterSize
+		STAGE_WRITE,   // formatting the output
+		NUM_RUN_STAGES
+	};
+
+	struct StageTime
+	{
+		double wall; // seconds
+		double cpu;
+	};
+
+	/**
+	 * One chromosome of one library, in one pass
+	 */
+	struct ChromStats
+	{
+		int library;  // position of its -i file
+		int pass;     // 1, or 2 for the -twopass second pass
+		int order;    // position of the chromosome in its library
+		std::string chrom;
+		long long tags;
+		long long candidates;
+		long long hotspots;
+		StageTime stages[ NUM_RUN_STAGES ];
+
+		ChromStats( );
+	};
+
+	/**
+	 * Times the stages of one chromosome, on the thread that runs them.  A
+	 * clock made for no ChromStats reads no clocks.
+	 */
+	class StageClock
+	{
+	public:
+		explicit StageClock( ChromStats* stats );
+
+		/**
+		 * Start again from now, leaving the time since the last lap uncounted
+		 */
+		void start( );
+
+		/**
+		 * Add the time since the last lap, or since the clock was started, to
+		 * <stage>
+		 */
+		void lap( RunStage stage );
+
+	private:
+		ChromStats* _stats;
+		double _wall;
+		double _cpu;
+	};
+
+	class RunStats
+	{
+	public:
+		/**
+		 * Start timing the run of the command line <argv>
+		 */
+		RunStats( int argc, char** argv );
+		~RunStats( );
+
+		/**
+		 * Add a chromosome.  Safe to call from any thread.
+		 */
+		void addChrom( const ChromStats& chrom );
+
+		/**
+		 * Record what was parsed of the input library <path>
+		 */
+		void addInput( const std::string& path, long long bytes, long long lines );
+
+		/**
+		 * Raise the high-water mark of hotspot table storage to <bytes>, if it
+		 * is higher.  Safe to call from any thread.
+		 */
+		void noteArenaBytes( long long bytes );
+
+		/**
+		 * Write the report to <fileName>.  Returns false, having reported the
+		 * error, if it cannot be written.
+		 */
+		bool write( const std::string& fileName, int numThreads ) const;
+
+	private:
+		RunStats( const RunStats& );
+		RunStats& operator=( const RunStats& );
+
+		struct InputStats
+		{
+			std::string path;
+			long long bytes;
+			long long lines;
+		};
+
+		std::string _command;
+		double _startWall;
+		pthread_mutex_t _lock;
+		std::vector< ChromStats > _chroms;
+		std::vector< InputStats > _inputs;
+		long long _arenaBytes;
+	};
+
+} // namespace hotspot
+
+#endif /* RUN_STATS_HPP_ */
@@ -0,0 +1,156 @@
+/**
+ * File: SyntheticLibrary.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  An implementation of SyntheticLibrary.hpp
+ */
+
+#include "SyntheticLibrary.hpp"
+#include "RandomStream.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace hotspot
+{
+	// Each part of a chromosome is drawn from a stream of its own
+	enum SyntheticStream { MAPPABLE_STREAM = 1, BACKGROUND_STREAM, CENTER_STREAM, SIZE_STREAM, SPREAD_STREAM };
+
+	// Share of the bins, besides the unmappable ones, that are only partly mappable
+	static const double PARTLY_MAPPABLE = 0.15;
+
+	// Largest mean drawn at once by multiplying uniforms
+	static const double POISSON_STEP = 30.0;
+
+	static uint64_t StreamSeed( uint64_t seed, SyntheticStream stream )
+	{
+		return seed ^ ( static_cast< uint64_t >( stream ) << 56 );
+	}
+
+	/**
+	 * A Poisson count with mean <mean>.  A count with mean up to POISSON_STEP
+	 * is the number of uniforms whose running product stays above exp(-mean);
+	 * a larger mean is split into steps, as a sum of Poisson counts is
+	 * Poisson.  It costs about one uniform per unit of the mean.
+	 */
+	static int Poisson( RandomStream& stream, double mean )
+	{
+		int count = 0;
+		while( mean > 0.0 )
+		{
+			double step = std::min( mean, POISSON_STEP );
+			double limit = std::exp( -step );
+			double product = stream.uniform( );
+			while( product > limit )
+			{
+				product *= stream.uniform( );
+				count++;
+			}
+			mean -= step;
+		}
+		return count;
+	}
+
+	void SyntheticGenome( const SyntheticParams& params, std::vector< MappableChrom >& chroms )
+	{
+		std::vector< std::string > names;
+		for( int c = 1; c <= params.numChroms; c++ )
+		{
+			char name[32];
+			std::snprintf( name, sizeof( name ), "chr%d", c );
+			names.push_back( name );
+		}
+		std::sort( names.begin( ), names.end( ) );
+
+		chroms.clear( );
+		for( unsigned int c = 0; c < names.size( ); c++ )
+		{
+			chroms.push_back( MappableChrom( ) );
+			MappableChrom& chrom = chroms.back( );
+			chrom.name = names[c];
+			chrom.weight = 0;
+			RandomStream stream( StreamSeed( params.seed, MAPPABLE_STREAM ), chrom.name );
+			for( int start = 0; start < params.chromSize; start += params.binSize )
+			{
+				MappableSegment segment;
+				segment.start = start;
+				segment.length = std::min( params.binSize, params.chromSize - start );
+				double u = stream.uniform( );
+				if( u < params.unmappable )
+				{
+					segment.weight = 0;
+				}
+				else if( u < params.unmappable + PARTLY_MAPPABLE )
+				{
+					segment.weight = static_cast< int >( stream.uniform( ) * segment.length );
+				}
+				else
+				{
+					segment.weight = segment.length;
+				}
+				chrom.segments.push_back( segment );
+				chrom.weight += segment.weight;
+			}
+		}
+	}
+
+	void AllotSyntheticTags( const SyntheticParams& params, const std::vector< MappableChrom >& chroms,
+							 std::vector< long long >& numBackground, std::vector< long long >& numHotspots )
+	{
+		long long background = static_cast< long long >( params.numTags * ( 1.0 - params.spot ) + 0.5 );
+		long long hotspots = 0;
+		if( params.hotspotDepth > 0.0 )
+		{
+			hotspots = static_cast< long long >( params.numTags * params.spot / params.hotspotDepth + 0.5 );
+		}
+		AllotTags( background, chroms, numBackground );
+		AllotTags( hotspots, chroms, numHotspots );
+	}
+
+	void SyntheticHotspotSizes( const SyntheticParams& params, const MappableChrom& chrom, long long numHotspots,
+								std::vector< int >& sizes )
+	{
+		RandomStream stream( StreamSeed( params.seed, SIZE_STREAM ), chrom.name );
+		sizes.resize( numHotspots );
+		for( long long h = 0; h < numHotspots; h++ )
+		{
+			sizes[h] = Poisson( stream, params.hotspotDepth );
+		}
+	}
+
+	void SyntheticTags( const SyntheticParams& params, const MappableChrom& chrom, long long numBackground,
+						long long numHotspots, std::vector< int >& tags )
+	{
+		SampleTags( chrom, numBackground, StreamSeed( params.seed, BACKGROUND_STREAM ), tags );
+		if( numHotspots == 0 || chrom.weight == 0 )
+		{
+			return;
+		}
+
+		// Hotspots are centered on mappable bases, but their tags spread
+		// evenly over their whole width, clipped to the chromosome
+		std::vector< int > sizes;
+		std::vector< int > centers;
+		SyntheticHotspotSizes( params, chrom, numHotspots, sizes );
+		SampleTags( chrom, numHotspots, StreamSeed( params.seed, CENTER_STREAM ), centers );
+		const MappableSegment& last = chrom.segments.back( );
+		int chromEnd = last.start + last.length;
+		RandomStream stream( StreamSeed( params.seed, SPREAD_STREAM ), chrom.name );
+		std::vector< int >::size_type numBackgroundTags = tags.size( );
+		for( long long h = 0; h < numHotspots; h++ )
+		{
+			int left = centers[h] - params.hotspotWidth / 2;
+			for( int i = 0; i < sizes[h]; i++ )
+			{
+				int pos = left + static_cast< int >( stream.uniform( ) * params.hotspotWidth );
+				tags.push_back( std::max( 0, std::min( pos, chromEnd - 1 ) ) );
+			}
+		}
+		std::sort( tags.begin( ) + numBackgroundTags, tags.end( ) );
+		std::inplace_merge( tags.begin( ), tags.begin( ) + numBackgroundTags, tags.end( ) );
+	}
+}
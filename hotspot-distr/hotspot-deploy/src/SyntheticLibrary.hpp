@@ -0,0 +1,78 @@
+/**
+ * File: SyntheticLibrary.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  Synthetic tag libraries, for benchmarking: tags placed uniformly over
+ *  the mappable part of a made-up genome, plus planted hotspots, each
+ *  holding a Poisson number of tags spread over a few hundred bases.
+ *  The mappable bases of each bin of the genome are drawn along with it,
+ *  so the library comes with a matching mappable counts background.
+ *
+ *  As for RandomLibrary.hpp, each chromosome is drawn from its own
+ *  random streams, keyed by the seed and the chromosome name, so any
+ *  chromosome can be generated on its own, in any order, with the same
+ *  result.
+ */
+
+#ifndef SYNTHETIC_LIBRARY_HPP_
+#define SYNTHETIC_LIBRARY_HPP_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "RandomLibrary.hpp"
+
+namespace hotspot
+{
+
+	struct SyntheticParams
+	{
+		long long numTags;  // background tags, plus the mean tags of the planted hotspots
+		int numChroms;
+		int chromSize;
+		int binSize;        // of the mappable counts
+		double unmappable;  // share of bins with nothing mappable
+		double spot;        // share of the tags in planted hotspots
+		double hotspotDepth; // mean tags per planted hotspot
+		int hotspotWidth;
+		uint64_t seed;
+	};
+
+	/**
+	 * Draw the genome of <params> into <chroms>, in the lexicographic order of
+	 * their names (chr1, chr10, chr11, ...), with one segment per bin.  Bins
+	 * with nothing mappable are kept, with no weight, so that each segment's
+	 * weight is the mappable count of its bin.
+	 */
+	void SyntheticGenome( const SyntheticParams& params, std::vector< MappableChrom >& chroms );
+
+	/**
+	 * Divide the background tags and planted hotspots of <params> among
+	 * <chroms>, in proportion to their mappable bases
+	 */
+	void AllotSyntheticTags( const SyntheticParams& params, const std::vector< MappableChrom >& chroms,
+							 std::vector< long long >& numBackground, std::vector< long long >& numHotspots );
+
+	/**
+	 * Draw the number of tags in each of <numHotspots> planted hotspots of
+	 * <chrom> into <sizes>.  This is cheap, so the size of a library can be
+	 * known before its tags are drawn.
+	 */
+	void SyntheticHotspotSizes( const SyntheticParams& params, const MappableChrom& chrom, long long numHotspots,
+								std::vector< int >& sizes );
+
+	/**
+	 * Draw the tags of <chrom>, <numBackground> uniform over its mappable
+	 * bases and the rest in <numHotspots> planted hotspots, in sorted order,
+	 * into <tags>
+	 */
+	void SyntheticTags( const SyntheticParams& params, const MappableChrom& chrom, long long numBackground,
+						long long numHotspots, std::vector< int >& tags );
+
+} // namespace hotspot
+
+#endif /* SYNTHETIC_LIBRARY_HPP_ */
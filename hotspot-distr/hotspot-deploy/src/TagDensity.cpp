@@ -0,0 +1,59 @@
+/**
+ * File: TagDensity.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  An implementation of TagDensity.hpp
+ */
+
+#include "TagDensity.hpp"
+
+namespace hotspot
+{
+	bool TagDensity( const std::vector< int >& tags, const Interval& extent, int window, int step,
+					 int& firstTile, std::vector< double >& density )
+	{
+		int numTags = tags.size( );
+		for( int k = 1; k < numTags; k++ )
+		{
+			if( tags[k] < tags[ k - 1 ] )
+			{
+				return false;
+			}
+		}
+
+		// As the run_wavelet_peak_finding tiling: tiles start half a window
+		// less half a step in from the chromosome start, and the last starts
+		// before half a window plus half a step short of its end
+		int pad = window / 2 - step / 2;
+		int lastTileBound = extent.end - window / 2 - step / 2;
+		firstTile = extent.start + pad;
+		density.clear( );
+		if( lastTileBound - firstTile > 0 )
+		{
+			density.reserve( ( lastTileBound - firstTile + step - 1 ) / step );
+		}
+
+		int lo = 0, hi = 0;
+		for( int tile = firstTile; tile < lastTileBound; tile += step )
+		{
+			// Tags in [tile - pad, tile + step + pad)
+			while( lo < numTags && tags[ lo ] < tile - pad )
+			{
+				lo++;
+			}
+			if( hi < lo )
+			{
+				hi = lo;
+			}
+			while( hi < numTags && tags[ hi ] < tile + step + pad )
+			{
+				hi++;
+			}
+			density.push_back( hi - lo );
+		}
+		return true;
+	}
+}
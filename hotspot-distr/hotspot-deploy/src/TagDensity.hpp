@@ -0,0 +1,38 @@
+/**
+ * File: TagDensity.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  The sliding-window tag density that peak-finding smooths, in place of
+ *  the awk tiling and bedmap --range --count steps of
+ *  run_wavelet_peak_finding.  Tiles of one step tile each chromosome, the
+ *  first centered half a window in from its start, and the density of a
+ *  tile is the number of tags in the window centered on it.  The tags are
+ *  swept once, with one pointer at each edge of the window, so the track
+ *  takes time in proportion to the tags plus the tiles.
+ */
+
+#ifndef TAG_DENSITY_HPP_
+#define TAG_DENSITY_HPP_
+
+#include <vector>
+
+#include "IntervalSet.hpp"
+
+namespace hotspot
+{
+
+	/**
+	 * Set <firstTile> to the start of the first <step> tile of <extent>, and
+	 * <density> to the number of <tags> within the <window> centered on each
+	 * tile, as bedmap --range ( window / 2 - step / 2 ) --count counts them.
+	 * <tags> must be sorted; returns false if they are not.
+	 */
+	bool TagDensity( const std::vector< int >& tags, const Interval& extent, int window, int step,
+					 int& firstTile, std::vector< double >& density );
+
+} // namespace hotspot
+
+#endif /* TAG_DENSITY_HPP_ */
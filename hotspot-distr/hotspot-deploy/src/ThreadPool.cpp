@@ -0,0 +1,269 @@
+/**
+ * File: ThreadPool.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  An implementation of ThreadPool.hpp
+ */
+
+#include "ThreadPool.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/time.h>
+
+namespace hotspot
+{
+	// Identifies the pool worker, if any, running on the current thread
+	static __thread ThreadPool* tlsPool = NULL;
+	static __thread int tlsWorker = -1;
+
+	ThreadPool::TaskGroup::TaskGroup( )
+		: _pending( 0 )
+	{
+		pthread_mutex_init( &_lock, NULL );
+		pthread_cond_init( &_done, NULL );
+	}
+
+	ThreadPool::TaskGroup::~TaskGroup( )
+	{
+		pthread_cond_destroy( &_done );
+		pthread_mutex_destroy( &_lock );
+	}
+
+	ThreadPool::ThreadPool( int numThreads )
+		: _numThreads( numThreads < 1 ? 1 : numThreads ), _queued( 0 ), _shutdown( false )
+	{
+		pthread_mutex_init( &_lock, NULL );
+		pthread_cond_init( &_workAvailable, NULL );
+
+		// All workers exist before any of them starts looking for work
+		for( int i = 0; i < _numThreads - 1; i++ )
+		{
+			Worker* w = new Worker;
+			w->pool = this;
+			w->index = i;
+			pthread_mutex_init( &w->lock, NULL );
+			_workers.push_back( w );
+		}
+		for( unsigned int i = 0; i < _workers.size( ); i++ )
+		{
+			int status = pthread_create( &_workers[i]->thread, NULL, workerMain, _workers[i] );
+			if( status != 0 )
+			{
+				std::fprintf( stderr, "Error: unable to start worker thread: %s\n", std::strerror( status ) );
+				std::exit( EXIT_FAILURE );
+			}
+		}
+	}
+
+	ThreadPool::~ThreadPool( )
+	{
+		pthread_mutex_lock( &_lock );
+		_shutdown = true;
+		pthread_cond_broadcast( &_workAvailable );
+		pthread_mutex_unlock( &_lock );
+
+		for( unsigned int i = 0; i < _workers.size( ); i++ )
+		{
+			pthread_join( _workers[i]->thread, NULL );
+		}
+		for( unsigned int i = 0; i < _workers.size( ); i++ )
+		{
+			pthread_mutex_destroy( &_workers[i]->lock );
+			delete _workers[i];
+		}
+		pthread_cond_destroy( &_workAvailable );
+		pthread_mutex_destroy( &_lock );
+	}
+
+	int ThreadPool::numThreads( ) const
+	{
+		return _numThreads;
+	}
+
+	void ThreadPool::submit( Task* task, TaskGroup& group )
+	{
+		Job job;
+		job.task = task;
+		job.group = &group;
+
+		pthread_mutex_lock( &group._lock );
+		group._pending++;
+		pthread_mutex_unlock( &group._lock );
+
+		if( tlsPool == this )
+		{
+			Worker* self = _workers[ tlsWorker ];
+			pthread_mutex_lock( &self->lock );
+			self->jobs.push_back( job );
+			pthread_mutex_unlock( &self->lock );
+
+			pthread_mutex_lock( &_lock );
+		}
+		else
+		{
+			pthread_mutex_lock( &_lock );
+			_shared.push_back( job );
+		}
+		_queued++;
+		pthread_cond_signal( &_workAvailable );
+		pthread_mutex_unlock( &_lock );
+	}
+
+	void ThreadPool::wait( TaskGroup& group )
+	{
+		int self = ( tlsPool == this ) ? tlsWorker : -1;
+		while( true )
+		{
+			pthread_mutex_lock( &group._lock );
+			int pending = group._pending;
+			pthread_mutex_unlock( &group._lock );
+			if( pending == 0 )
+			{
+				return;
+			}
+
+			Job job;
+			if( findJob( self, job ) )
+			{
+				runJob( job );
+				continue;
+			}
+
+			// Nothing left to run here; the group's last tasks are running on
+			// other threads.  Wake up periodically in case new work is queued.
+			struct timeval now;
+			gettimeofday( &now, NULL );
+			struct timespec until;
+			until.tv_sec = now.tv_sec;
+			until.tv_nsec = now.tv_usec * 1000 + 1000000;
+			if( until.tv_nsec >= 1000000000 )
+			{
+				until.tv_sec++;
+				until.tv_nsec -= 1000000000;
+			}
+			pthread_mutex_lock( &group._lock );
+			if( group._pending > 0 )
+			{
+				pthread_cond_timedwait( &group._done, &group._lock, &until );
+			}
+			pthread_mutex_unlock( &group._lock );
+		}
+	}
+
+	void* ThreadPool::workerMain( void* arg )
+	{
+		Worker* w = static_cast< Worker* >( arg );
+		ThreadPool* pool = w->pool;
+		tlsPool = pool;
+		tlsWorker = w->index;
+
+		while( true )
+		{
+			Job job;
+			if( pool->findJob( w->index, job ) )
+			{
+				pool->runJob( job );
+				continue;
+			}
+
+			pthread_mutex_lock( &pool->_lock );
+			while( pool->_queued == 0 && ! pool->_shutdown )
+			{
+				pthread_cond_wait( &pool->_workAvailable, &pool->_lock );
+			}
+			bool stop = pool->_shutdown && pool->_queued == 0;
+			pthread_mutex_unlock( &pool->_lock );
+			if( stop )
+			{
+				break;
+			}
+		}
+		return NULL;
+	}
+
+	bool ThreadPool::findJob( int self, Job& job )
+	{
+		// Own queue first, newest job first
+		if( self >= 0 )
+		{
+			Worker* w = _workers[ self ];
+			pthread_mutex_lock( &w->lock );
+			bool found = ! w->jobs.empty( );
+			if( found )
+			{
+				job = w->jobs.back( );
+				w->jobs.pop_back( );
+				pthread_mutex_lock( &_lock );
+				_queued--;
+				pthread_mutex_unlock( &_lock );
+			}
+			pthread_mutex_unlock( &w->lock );
+			if( found )
+			{
+				return true;
+			}
+		}
+
+		// Then jobs from outside the pool, in submission order
+		pthread_mutex_lock( &_lock );
+		bool found = ! _shared.empty( );
+		if( found )
+		{
+			job = _shared.front( );
+			_shared.pop_front( );
+			_queued--;
+		}
+		pthread_mutex_unlock( &_lock );
+		if( found )
+		{
+			return true;
+		}
+
+		// Then steal the oldest job from another worker
+		int numWorkers = _workers.size( );
+		for( int i = 1; i <= numWorkers; i++ )
+		{
+			int victim = ( self + i ) % numWorkers;
+			if( victim == self )
+			{
+				continue;
+			}
+			Worker* w = _workers[ victim ];
+			pthread_mutex_lock( &w->lock );
+			found = ! w->jobs.empty( );
+			if( found )
+			{
+				job = w->jobs.front( );
+				w->jobs.pop_front( );
+				pthread_mutex_lock( &_lock );
+				_queued--;
+				pthread_mutex_unlock( &_lock );
+			}
+			pthread_mutex_unlock( &w->lock );
+			if( found )
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void ThreadPool::runJob( const Job& job )
+	{
+		job.task->run( );
+
+		TaskGroup& group = *job.group;
+		pthread_mutex_lock( &group._lock );
+		group._pending--;
+		if( group._pending == 0 )
+		{
+			pthread_cond_broadcast( &group._done );
+		}
+		pthread_mutex_unlock( &group._lock );
+	}
+}
@@ -0,0 +1,120 @@
+/**
+ * File: ThreadPool.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  A small work-stealing thread pool on top of pthreads.  Tasks
+ *  submitted from outside the pool go on a shared queue, and are
+ *  started in submission order.  Tasks submitted from inside a
+ *  running task go on the submitting worker's own queue, where the
+ *  owner takes the newest first and idle workers steal the oldest.
+ *  A thread waiting on a TaskGroup runs queued tasks while it waits,
+ *  so tasks may themselves submit and wait on further tasks.
+ */
+
+#ifndef THREADPOOL_HPP_
+#define THREADPOOL_HPP_
+
+#include <deque>
+#include <vector>
+#include <pthread.h>
+
+namespace hotspot
+{
+
+	class ThreadPool
+	{
+	public:
+
+		/**
+		 * A unit of work.  The pool never takes ownership of a Task.
+		 */
+		class Task
+		{
+		public:
+			virtual ~Task( ) { }
+			virtual void run( ) = 0;
+		};
+
+		/**
+		 * Tracks completion of a set of submitted tasks
+		 */
+		class TaskGroup
+		{
+		public:
+			TaskGroup( );
+			~TaskGroup( );
+
+		private:
+			friend class ThreadPool;
+			pthread_mutex_t _lock;
+			pthread_cond_t _done;
+			int _pending;
+		};
+
+		/**
+		 * Start a pool that runs tasks on <numThreads> threads in total.  The
+		 * thread calling wait( ) counts as one of them, so numThreads - 1
+		 * workers are started; a pool of 1 runs every task inside wait( ).
+		 */
+		ThreadPool( int numThreads );
+
+		/**
+		 * Stop and join the workers.  All task groups must have been waited on.
+		 */
+		~ThreadPool( );
+
+		/**
+		 * Queue <task> to run as part of <group>
+		 */
+		void submit( Task* task, TaskGroup& group );
+
+		/**
+		 * Run queued tasks until every task in <group> has completed
+		 */
+		void wait( TaskGroup& group );
+
+		/**
+		 * Total number of threads that run tasks, including the waiting thread
+		 */
+		int numThreads( ) const;
+
+	private:
+		struct Job
+		{
+			Task* task;
+			TaskGroup* group;
+		};
+
+		struct Worker
+		{
+			ThreadPool* pool;
+			int index;
+			pthread_t thread;
+			pthread_mutex_t lock;
+			std::deque< Job > jobs;
+		};
+
+		static void* workerMain( void* arg );
+		bool findJob( int self, Job& job );
+		void runJob( const Job& job );
+
+		ThreadPool( const ThreadPool& );
+		ThreadPool& operator=( const ThreadPool& );
+
+		int _numThreads;
+		std::vector< Worker* > _workers;
+
+		// Guards the shared queue and the idle/shutdown state
+		pthread_mutex_t _lock;
+		pthread_cond_t _workAvailable;
+		std::deque< Job > _shared;
+		int _queued;
+		bool _shutdown;
+	};
+
+} // namespace hotspot
+
+#endif /* THREADPOOL_HPP_ */
@@ -0,0 +1,580 @@
+/**
+ * File: WavePeakFinder.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  Entry point of hotspot-wavepeaks, which smooths the signal in column 5
+ *  of a sorted bed file (see Wavelet.hpp) and writes the rows where the
+ *  smooth peaks, in place of the wavelets program and the per-chromosome
+ *  temporary files, paste and awk steps of wavePeaks.  The input is read
+ *  once; each chromosome is smoothed on a pool of threads as soon as its
+ *  rows are read, and its peaks and valleys are found in the same pass.
+ *  As in wavePeaks, a peak is the last row of a rise that is followed by
+ *  a fall, with level rows between them part of the rise, and a valley
+ *  the reverse.  Rows are written with the smoothed signal in column 5,
+ *  or unchanged at level 0, a chromosome at a time in name order, as
+ *  sort-bed orders them.
+ *
+ *  With -tags, the signal is instead the tag density of TagDensity.hpp,
+ *  counted from the sorted tags as each chromosome is read and handed to
+ *  the smoother directly, in place of the awk, bedmap and starch steps of
+ *  run_wavelet_peak_finding.  The track is written out as text only when
+ *  -density asks for it.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ByLine.hpp"
+#include "HotspotDefaults.hpp"
+#include "InputDataReader.hpp"
+#include "IntervalSet.hpp"
+#include "TagDensity.hpp"
+#include "ThreadPool.hpp"
+#include "Wavelet.hpp"
+
+namespace hotspot
+{
+	/**
+	 * Smooths the signal of one chromosome, and finds its peaks and valleys
+	 */
+	class ChromSmoother : public ThreadPool::Task
+	{
+	public:
+		std::string name;
+		const std::vector< double >* weights; // NULL at level 0
+		bool findPeaks;
+		bool findValleys;
+
+		// Columns 2 and 3 of each row, its signal, and the text that follows
+		// column 3 in the output: column 4, or the rest of the row at level 0
+		std::vector< int > starts;
+		std::vector< int > ends;
+		std::vector< double > signal;
+		std::vector< unsigned int > tailOffsets;
+		std::string tails;
+
+		// Rows of a tag density track, when tileStep is set: row t is the
+		// tile from tileStart + t tileStep, and only its signal is kept
+		int tileStart;
+		int tileStep;
+
+		std::string peaks;
+		std::string valleys;
+
+		ChromSmoother( ) : weights( NULL ), findPeaks( false ), findValleys( false ), tileStart( 0 ), tileStep( 0 ) { }
+
+		void run( )
+		{
+			std::vector< double > smooth;
+			if( weights != NULL )
+			{
+				WaveletSmooth( signal, *weights, smooth );
+			}
+			const std::vector< double >& values = ( weights != NULL ) ? smooth : signal;
+
+			bool rising = false;
+			bool falling = false;
+			for( unsigned int t = 1; t < values.size( ); t++ )
+			{
+				double change = values[t] - values[ t - 1 ];
+				if( rising && change < 0 )
+				{
+					if( findPeaks )
+					{
+						writeRow( t - 1, values[ t - 1 ], peaks );
+					}
+					rising = false;
+				}
+				else if( ! rising && change > 0 )
+				{
+					rising = true;
+				}
+				if( falling && change > 0 )
+				{
+					if( findValleys )
+					{
+						writeRow( t - 1, values[ t - 1 ], valleys );
+					}
+					falling = false;
+				}
+				else if( ! falling && change < 0 )
+				{
+					falling = true;
+				}
+			}
+
+			std::vector< int >( ).swap( starts );
+			std::vector< int >( ).swap( ends );
+			std::vector< double >( ).swap( signal );
+			std::vector< unsigned int >( ).swap( tailOffsets );
+			std::string( ).swap( tails );
+		}
+
+	private:
+		void writeRow( unsigned int t, double value, std::string& out ) const
+		{
+			char columns[64];
+			out += name;
+			if( tileStep > 0 )
+			{
+				int start = tileStart + static_cast< int >( t ) * tileStep;
+				std::snprintf( columns, sizeof( columns ), "\t%d\t%d\t.", start, start + tileStep );
+				out += columns;
+				if( weights == NULL )
+				{
+					std::snprintf( columns, sizeof( columns ), "\t%d\n", static_cast< int >( value ) );
+					out += columns;
+					return;
+				}
+			}
+			else
+			{
+				std::snprintf( columns, sizeof( columns ), "\t%d\t%d\t", starts[t], ends[t] );
+				out += columns;
+				out.append( tails, tailOffsets[t], tailOffsets[ t + 1 ] - tailOffsets[t] );
+			}
+			if( weights != NULL )
+			{
+				std::snprintf( columns, sizeof( columns ), "\t%f", value );
+				out += columns;
+			}
+			out += '\n';
+		}
+	};
+
+	/**
+	 * Split the next whitespace-delimited field from <p>, and advance <p>
+	 * past it.  Returns false if there is none.
+	 */
+	static bool NextField( const char*& p, const char*& field, std::size_t& length )
+	{
+		while( *p == ' ' || *p == '\t' )
+		{
+			p++;
+		}
+		field = p;
+		while( *p != '\0' && *p != ' ' && *p != '\t' )
+		{
+			p++;
+		}
+		length = p - field;
+		return length > 0;
+	}
+
+	/**
+	 * The number in <field> of <length> characters; whole numbers, such as
+	 * tag counts, are read without strtod
+	 */
+	static double ParseNumber( const char* field, std::size_t length )
+	{
+		double value = 0.0;
+		std::size_t i = 0;
+		for( ; i < length && static_cast< unsigned char >( field[i] - '0' ) <= 9 && i < 15; i++ )
+		{
+			value = value * 10 + ( field[i] - '0' );
+		}
+		return ( i == length ) ? value : std::strtod( field, NULL );
+	}
+
+	/**
+	 * Read the rows of the bed file <fileName>, or standard input for "-",
+	 * into <smoothers>, one per chromosome, and submit each to <pool> once
+	 * its rows are read.  Rows of chromosomes not in <chroms>, unless it is
+	 * empty, are skipped.  Returns false, after reporting why, on error.
+	 */
+	bool ReadSignal( const std::string& fileName, const std::set< std::string >& chroms, bool keepRows,
+					 std::vector< ChromSmoother* >& smoothers, const ChromSmoother& prototype,
+					 ThreadPool& pool, ThreadPool::TaskGroup& group )
+	{
+		std::ifstream file;
+		if( fileName != "-" )
+		{
+			file.open( fileName.c_str( ) );
+			if( ! file )
+			{
+				std::fprintf( stderr, "Error: unable to access %s\n", fileName.c_str( ) );
+				return false;
+			}
+		}
+		std::istream& in = ( fileName == "-" ) ? std::cin : file;
+
+		std::set< std::string > seen;
+		std::string currentChrom;
+		bool skipping = false;
+		ChromSmoother* smoother = NULL;
+		int lineNum = 0;
+		ByLine line;
+		while( in >> line )
+		{
+			lineNum++;
+			const char* p = line.c_str( );
+			const char* fields[5];
+			std::size_t lengths[5];
+			int numFields = 0;
+			while( numFields < 5 && NextField( p, fields[ numFields ], lengths[ numFields ] ) )
+			{
+				numFields++;
+			}
+			if( numFields == 0 )
+			{
+				continue;
+			}
+			if( numFields < 5 )
+			{
+				std::fprintf( stderr, "Error: input file %s contains a malformed entry on line %d\n",
+						fileName.c_str( ), lineNum );
+				return false;
+			}
+
+			if( currentChrom.compare( 0, std::string::npos, fields[0], lengths[0] ) != 0 )
+			{
+				if( smoother != NULL )
+				{
+					smoother->tailOffsets.push_back( smoother->tails.size( ) );
+					pool.submit( smoother, group );
+					smoother = NULL;
+				}
+				currentChrom.assign( fields[0], lengths[0] );
+				if( ! seen.insert( currentChrom ).second )
+				{
+					std::fprintf( stderr, "Error: %s must be sorted; %s appears in more than one place\n",
+							fileName.c_str( ), currentChrom.c_str( ) );
+					return false;
+				}
+				skipping = ! chroms.empty( ) && chroms.find( currentChrom ) == chroms.end( );
+				if( ! skipping )
+				{
+					smoother = new ChromSmoother( prototype );
+					smoother->name = currentChrom;
+					smoothers.push_back( smoother );
+				}
+			}
+			if( skipping )
+			{
+				continue;
+			}
+
+			smoother->starts.push_back( static_cast< int >( ParseNumber( fields[1], lengths[1] ) ) );
+			smoother->ends.push_back( static_cast< int >( ParseNumber( fields[2], lengths[2] ) ) );
+			smoother->signal.push_back( ParseNumber( fields[4], lengths[4] ) );
+			smoother->tailOffsets.push_back( smoother->tails.size( ) );
+			if( keepRows )
+			{
+				smoother->tails.append( fields[3], line.c_str( ) + line.size( ) - fields[3] );
+			}
+			else
+			{
+				smoother->tails.append( fields[3], lengths[3] );
+			}
+		}
+		if( smoother != NULL )
+		{
+			smoother->tailOffsets.push_back( smoother->tails.size( ) );
+			pool.submit( smoother, group );
+		}
+		return true;
+	}
+
+	/**
+	 * Write the density track of <smoother> to <fp>, as the bedmap --echo
+	 * --count rows of run_wavelet_peak_finding: <chrom> <start> <end> . <count>
+	 */
+	void WriteDensity( std::FILE* fp, const ChromSmoother& smoother )
+	{
+		char line[ HotspotDefaults::MAX_CHROM_NAME_LEN + 48 ];
+		for( unsigned int t = 0; t < smoother.signal.size( ); t++ )
+		{
+			int start = smoother.tileStart + static_cast< int >( t ) * smoother.tileStep;
+			int n = std::snprintf( line, sizeof( line ), "%s\t%d\t%d\t.\t%d\n", smoother.name.c_str( ),
+					start, start + smoother.tileStep, static_cast< int >( smoother.signal[t] ) );
+			std::fwrite( line, 1, n, fp );
+		}
+	}
+
+	/**
+	 * Count the density track of the sorted tags in <fileName>, or standard
+	 * input for "-", over each chromosome of <extents> into <smoothers>, and
+	 * submit each to <pool> once it is counted.  Chromosomes without tags
+	 * get a track of zeros, and tags of chromosomes not in <extents> are
+	 * skipped.  The track is also written to <density>, unless it is NULL,
+	 * in name order.  Returns false, after reporting why, on error.
+	 */
+	bool ReadTags( const std::string& fileName, const std::map< std::string, Interval >& extents,
+				   int window, int step, std::FILE* density,
+				   std::vector< ChromSmoother* >& smoothers, const ChromSmoother& prototype,
+				   ThreadPool& pool, ThreadPool::TaskGroup& group )
+	{
+		const char* inputName = ( fileName == "-" ) ? "standard input" : fileName.c_str( );
+		InputDataReader reader( fileName );
+		std::map< std::string, Interval >::const_iterator next = extents.begin( );
+		std::string lastChrom;
+		std::vector< int > tags;
+		while( true )
+		{
+			tags.clear( );
+			int numTags = reader.readNextChrom( tags );
+			if( numTags < 0 )
+			{
+				return false; // malformed input, already reported
+			}
+			std::string chromName;
+			if( numTags > 0 )
+			{
+				chromName = reader.currentChromName( );
+				if( ! lastChrom.empty( ) && chromName <= lastChrom )
+				{
+					std::fprintf( stderr, "Error: %s must be sorted; %s is out of order\n",
+							inputName, chromName.c_str( ) );
+					return false;
+				}
+				lastChrom = chromName;
+			}
+
+			// The chromosomes before this one, if any, have no tags
+			while( next != extents.end( ) && ( numTags == 0 || next->first <= chromName ) )
+			{
+				bool hasTags = ( numTags > 0 && next->first == chromName );
+				ChromSmoother* smoother = new ChromSmoother( prototype );
+				smoother->name = next->first;
+				smoother->tileStep = step;
+				smoothers.push_back( smoother );
+				if( ! TagDensity( hasTags ? tags : std::vector< int >( ), next->second, window, step,
+								  smoother->tileStart, smoother->signal ) )
+				{
+					std::fprintf( stderr, "Error: %s must be sorted; %s has tags out of order\n",
+							inputName, next->first.c_str( ) );
+					return false;
+				}
+				if( density != NULL )
+				{
+					WriteDensity( density, *smoother );
+				}
+				pool.submit( smoother, group );
+				++next;
+			}
+			if( numTags == 0 )
+			{
+				return true;
+			}
+		}
+	}
+
+	bool byName( const ChromSmoother* a, const ChromSmoother* b )
+	{
+		return a->name < b->name;
+	}
+}
+
+int main( int argc, char **argv )
+{
+	std::string inputPath = "-", tagsPath, chromsPath, peaksPath, valleysPath, densityPath;
+	std::string filterName = "Haar";
+	int level = hotspot::HotspotDefaults::PEAK_SMOOTH_LEVEL;
+	int window = hotspot::HotspotDefaults::PEAK_DENSITY_WIN;
+	int step = hotspot::HotspotDefaults::PEAK_DENSITY_STEP;
+	int numThreads = hotspot::HotspotDefaults::NUM_THREADS;
+	for( int i = 1; i < argc; i++ )
+	{
+		bool hasValue = ( i + 1 < argc );
+		if( std::strcmp( argv[ i ], "-i" ) == 0 && hasValue )
+		{
+			inputPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-tags" ) == 0 && hasValue )
+		{
+			tagsPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-density" ) == 0 && hasValue )
+		{
+			densityPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-win" ) == 0 && hasValue )
+		{
+			window = std::atoi( argv[ ++i ] );
+		}
+		else if( std::strcmp( argv[ i ], "-step" ) == 0 && hasValue )
+		{
+			step = std::atoi( argv[ ++i ] );
+		}
+		else if( std::strcmp( argv[ i ], "-level" ) == 0 && hasValue )
+		{
+			level = std::atoi( argv[ ++i ] );
+		}
+		else if( std::strcmp( argv[ i ], "-filter" ) == 0 && hasValue )
+		{
+			filterName = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-chroms" ) == 0 && hasValue )
+		{
+			chromsPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-peaks" ) == 0 && hasValue )
+		{
+			peaksPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-valleys" ) == 0 && hasValue )
+		{
+			valleysPath = argv[ ++i ];
+		}
+		else if( std::strcmp( argv[ i ], "-threads" ) == 0 && hasValue )
+		{
+			numThreads = std::atoi( argv[ ++i ] );
+		}
+		else
+		{
+			std::cerr << "Unrecognized option: " << argv[ i ] << ". Aborting." << std::endl;
+			std::exit( EXIT_FAILURE );
+		}
+	}
+	std::vector< double > scalingFilter;
+	if( level < 0 || level > 20 || ! hotspot::ModwtScalingFilter( filterName, scalingFilter )
+		|| ( peaksPath.empty( ) && valleysPath.empty( ) && densityPath.empty( ) )
+		|| ( ! tagsPath.empty( ) && ( chromsPath.empty( ) || step <= 0 || window < step ) )
+		|| ( ! densityPath.empty( ) && tagsPath.empty( ) )
+		|| ( densityPath == "-" && ( peaksPath == "-" || valleysPath == "-" ) ) )
+	{
+		std::string msg  = "Usage: hotspot-wavepeaks (-peaks <file-name> | -valleys <file-name>) [options]";
+		msg += "\n    -peaks <file-name> (rows where the smoothed signal peaks; - for standard output)";
+		msg += "\n    -valleys <file-name> (rows where it bottoms out; - for standard output)";
+		msg += "\n    -i <file-name> (sorted bed, with the signal in column 5; - for standard input - default=-)";
+		msg += "\n    -tags <file-name> (sorted tags, bed or tag library, whose density is the signal in place of -i;";
+		msg += "\n        - for standard input; needs -chroms)";
+		msg += "\n    -density <file-name> (also write the -tags density, bed; - for standard output)";
+		msg += "\n    -win <int> (width of the -tags density window - default=150)";
+		msg += "\n    -step <int> (distance between -tags density windows - default=20)";
+		msg += "\n    -level <int> (smooth to a scale of 2^level rows; 0 for no smoothing - default=3)";
+		msg += "\n    -filter <Haar|LA8> (wavelet filter - default=Haar)";
+		msg += "\n    -chroms <file-name> (only the chromosomes listed in the first column; with -tags, their extents, bed)";
+		msg += "\n    -threads <int> (number of threads - default=1)";
+		msg += "\n";
+		std::cerr << msg << std::endl;
+		std::exit( EXIT_FAILURE );
+	}
+
+	std::set< std::string > chroms;
+	std::map< std::string, hotspot::Interval > extents;
+	if( ! chromsPath.empty( ) )
+	{
+		std::ifstream in( chromsPath.c_str( ) );
+		if( ! in )
+		{
+			std::fprintf( stderr, "Error: unable to access %s\n", chromsPath.c_str( ) );
+			std::exit( EXIT_FAILURE );
+		}
+		char name[ hotspot::HotspotDefaults::MAX_CHROM_NAME_LEN + 1 ];
+		int start, end;
+		ByLine line;
+		while( in >> line )
+		{
+			int numFields = std::sscanf( line.c_str( ), "%127s %d %d", name, &start, &end );
+			if( numFields >= 1 )
+			{
+				chroms.insert( name );
+			}
+			if( numFields == 3 )
+			{
+				extents.insert( std::make_pair( std::string( name ), hotspot::Interval( start, end ) ) );
+			}
+			else if( numFields >= 1 && ! tagsPath.empty( ) )
+			{
+				std::fprintf( stderr, "Error: %s has no extent for %s\n", chromsPath.c_str( ), name );
+				std::exit( EXIT_FAILURE );
+			}
+		}
+	}
+
+	std::vector< double > weights;
+	hotspot::ChromSmoother prototype;
+	if( level > 0 )
+	{
+		hotspot::ModwtSmoothingFilter( scalingFilter, level, weights );
+		prototype.weights = &weights;
+	}
+	prototype.findPeaks = ! peaksPath.empty( );
+	prototype.findValleys = ! valleysPath.empty( );
+
+	std::FILE* density = NULL;
+	if( ! densityPath.empty( ) )
+	{
+		density = ( densityPath == "-" ) ? stdout : std::fopen( densityPath.c_str( ), "w" );
+		if( density == NULL )
+		{
+			std::fprintf( stderr, "Error: unable to open %s\n", densityPath.c_str( ) );
+			std::exit( EXIT_FAILURE );
+		}
+	}
+
+	std::vector< hotspot::ChromSmoother* > smoothers;
+	{
+		hotspot::ThreadPool pool( numThreads );
+		hotspot::ThreadPool::TaskGroup group;
+		bool ok;
+		if( tagsPath.empty( ) )
+		{
+			ok = hotspot::ReadSignal( inputPath, chroms, level == 0, smoothers, prototype, pool, group );
+		}
+		else
+		{
+			ok = hotspot::ReadTags( tagsPath, extents, window, step, density, smoothers, prototype, pool, group );
+		}
+		pool.wait( group );
+		if( ! ok )
+		{
+			std::exit( EXIT_FAILURE );
+		}
+	}
+	if( density != NULL )
+	{
+		bool ok = ! std::ferror( density );
+		ok = ( std::fclose( density ) == 0 ) && ok;
+		if( ! ok )
+		{
+			std::fprintf( stderr, "Error: unable to write %s\n", densityPath.c_str( ) );
+			std::exit( EXIT_FAILURE );
+		}
+	}
+	std::sort( smoothers.begin( ), smoothers.end( ), hotspot::byName );
+
+	std::string paths[2] = { peaksPath, valleysPath };
+	for( int f = 0; f < 2; f++ )
+	{
+		if( paths[f].empty( ) )
+		{
+			continue;
+		}
+		std::FILE* fp = ( paths[f] == "-" ) ? stdout : std::fopen( paths[f].c_str( ), "w" );
+		if( fp == NULL )
+		{
+			std::fprintf( stderr, "Error: unable to open %s\n", paths[f].c_str( ) );
+			std::exit( EXIT_FAILURE );
+		}
+		for( unsigned int c = 0; c < smoothers.size( ); c++ )
+		{
+			const std::string& rows = ( f == 0 ) ? smoothers[c]->peaks : smoothers[c]->valleys;
+			std::fwrite( rows.data( ), 1, rows.size( ), fp );
+		}
+		bool ok = ! std::ferror( fp );
+		ok = ( std::fclose( fp ) == 0 ) && ok;
+		if( ! ok )
+		{
+			std::fprintf( stderr, "Error: unable to write %s\n", paths[f].c_str( ) );
+			std::exit( EXIT_FAILURE );
+		}
+	}
+	for( unsigned int c = 0; c < smoothers.size( ); c++ )
+	{
+		delete smoothers[c];
+	}
+	std::exit( EXIT_SUCCESS );
+}
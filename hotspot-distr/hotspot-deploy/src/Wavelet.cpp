@@ -0,0 +1,117 @@
+/**
+ * File: Wavelet.cpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  An implementation of Wavelet.hpp
+ */
+
+#include "Wavelet.hpp"
+
+#include <cmath>
+
+namespace hotspot
+{
+	// Daubechies least asymmetric scaling filter of width 8, as tabulated
+	// by Percival and Walden, Wavelet Methods for Time Series Analysis
+	static const double LA8_FILTER[] = {
+		-0.0757657147893407, -0.0296355276459541, 0.4976186676324578, 0.8037387518052163,
+		0.2978577956055422, -0.0992195435769354, -0.0126039672622612, 0.0322231006040713
+	};
+
+	bool ModwtScalingFilter( const std::string& name, std::vector< double >& filter )
+	{
+		filter.clear( );
+		if( name == "Haar" )
+		{
+			// 1/sqrt(2) each, rescaled by 1/sqrt(2) for the MODWT
+			filter.assign( 2, 0.5 );
+			return true;
+		}
+		if( name == "LA8" )
+		{
+			for( unsigned int l = 0; l < sizeof( LA8_FILTER ) / sizeof( LA8_FILTER[0] ); l++ )
+			{
+				filter.push_back( LA8_FILTER[l] / std::sqrt( 2.0 ) );
+			}
+			return true;
+		}
+		return false;
+	}
+
+	void ModwtSmoothingFilter( const std::vector< double >& scalingFilter, int level, std::vector< double >& weights )
+	{
+		// Level j filters with the scaling filter spread 2^(j-1) apart, looking
+		// back on the way down and ahead on the way back up
+		int width = scalingFilter.size( );
+		int reach = ( ( 1 << level ) - 1 ) * ( width - 1 );
+		std::vector< double > composite( 2 * reach + 1, 0.0 );
+		std::vector< double > next( composite.size( ) );
+		composite[ reach ] = 1.0;
+		for( int pass = 0; pass < 2 * level; pass++ )
+		{
+			int j = ( pass < level ) ? pass + 1 : 2 * level - pass;
+			int spread = ( pass < level ) ? -( 1 << ( j - 1 ) ) : ( 1 << ( j - 1 ) );
+			next.assign( composite.size( ), 0.0 );
+			for( int k = 0; k < static_cast< int >( composite.size( ) ); k++ )
+			{
+				if( composite[k] == 0.0 )
+				{
+					continue;
+				}
+				for( int l = 0; l < width; l++ )
+				{
+					next[ k + spread * l ] += composite[k] * scalingFilter[l];
+				}
+			}
+			composite.swap( next );
+		}
+		weights.swap( composite );
+	}
+
+	/**
+	 * Index into a series of length <n> of position <u> of its reflected,
+	 * circular extension
+	 */
+	static inline int Reflect( long long u, long long n )
+	{
+		long long m = 2 * n;
+		u %= m;
+		if( u < 0 )
+		{
+			u += m;
+		}
+		return static_cast< int >( u < n ? u : m - 1 - u );
+	}
+
+	void WaveletSmooth( const std::vector< double >& signal, const std::vector< double >& weights,
+						std::vector< double >& smooth )
+	{
+		int n = signal.size( );
+		int reach = weights.size( ) / 2;
+		smooth.resize( n );
+		const double* w = &weights[ reach ];
+		for( int t = 0; t < n; t++ )
+		{
+			double sum = 0.0;
+			if( t >= reach && t + reach < n )
+			{
+				const double* x = &signal[t];
+				for( int k = -reach; k <= reach; k++ )
+				{
+					sum += w[k] * x[k];
+				}
+			}
+			else
+			{
+				for( int k = -reach; k <= reach; k++ )
+				{
+					sum += w[k] * signal[ Reflect( t + k, n ) ];
+				}
+			}
+			smooth[t] = sum;
+		}
+	}
+}
@@ -0,0 +1,54 @@
+/**
+ * File: Wavelet.hpp
+ * Author: Bob Thurman
+ * Date: October 17, 2026
+ * Version: $Id$
+ *
+ * Comments:
+ *  Wavelet smoothing of a signal, as the wavelets program computes it
+ *  for wavePeaks: the level J smooth of the maximal overlap discrete
+ *  wavelet transform (MODWT), with reflected boundaries.  The series is
+ *  extended by its own reverse to twice its length and treated as
+ *  circular, transformed down to level J, and rebuilt from the level J
+ *  scaling coefficients alone.
+ *
+ *  Every step of that is a circular filter, so the whole smooth is one
+ *  filter, of width 2 (2^J - 1) (L - 1) + 1 for a scaling filter of
+ *  width L.  It is worked out once, and applied to the signal in a single
+ *  pass that touches each value a filter's width at a time, instead of
+ *  2 J passes over a copy twice the size of the signal.  For the Haar
+ *  filter the weights are multiples of 1 / 4^J, so the smooth of whole
+ *  counts comes out exact.
+ */
+
+#ifndef WAVELET_HPP_
+#define WAVELET_HPP_
+
+#include <string>
+#include <vector>
+
+namespace hotspot
+{
+
+	/**
+	 * The MODWT scaling filter named <name>, Haar or LA8, into <filter>.
+	 * Returns false for any other name.
+	 */
+	bool ModwtScalingFilter( const std::string& name, std::vector< double >& filter );
+
+	/**
+	 * The level <level> MODWT smooth as a single filter: the smooth at t is
+	 * the sum of weights[ K + k ] x[ t + k ] for k from -K to K, where
+	 * weights has 2 K + 1 entries
+	 */
+	void ModwtSmoothingFilter( const std::vector< double >& scalingFilter, int level, std::vector< double >& weights );
+
+	/**
+	 * Apply <weights> to <signal>, reflected at both ends, into <smooth>
+	 */
+	void WaveletSmooth( const std::vector< double >& signal, const std::vector< double >& weights,
+						std::vector< double >& smooth );
+
+} // namespace hotspot
+
+#endif /* WAVELET_HPP_ */